@@ -21,6 +21,9 @@ public class CommonMover : ModuleRules
 		{
 			"CoreUObject",
 			"Engine",
+			"Chaos",
+			"Landscape",
+			"NavigationSystem",
 		});
 
 		SetupGameplayDebuggerSupport(Target);
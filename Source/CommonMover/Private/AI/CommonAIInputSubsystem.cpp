@@ -0,0 +1,205 @@
+// Copyright © 2024 MajorT. All Rights Reserved.
+
+
+#include "AI/CommonAIInputSubsystem.h"
+
+#include "Async/ParallelFor.h"
+#include "Examples/CommonMoverPawn.h"
+#include "NavigationPath.h"
+#include "NavigationSystem.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(CommonAIInputSubsystem)
+
+void UCommonAIInputSubsystem::Deinitialize()
+{
+	Agents.Empty();
+	AgentIndices.Empty();
+
+	Super::Deinitialize();
+}
+
+bool UCommonAIInputSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCommonAIInputSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (Agents.IsEmpty())
+	{
+		return;
+	}
+
+	// Gather the locations on the game thread, so steering doesn't touch any components
+	for (FCommonAIInputAgent& Agent : Agents)
+	{
+		const ACommonMoverPawn* Pawn = Agent.Pawn.Get();
+		if (Pawn && Agent.IsMoving())
+		{
+			Agent.Location = Pawn->GetActorLocation();
+		}
+		else
+		{
+			Agent.Corridor.Reset();
+			Agent.MoveInput = FVector::ZeroVector;
+		}
+	}
+
+	// Steer everyone in one batch
+	const EParallelForFlags Flags = (Agents.Num() < MinAgentsPerTask) ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None;
+	ParallelFor(Agents.Num(), [this](int32 AgentIdx)
+	{
+		SteerAgent(Agents[AgentIdx]);
+	}, Flags);
+}
+
+TStatId UCommonAIInputSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCommonAIInputSubsystem, STATGROUP_Tickables);
+}
+
+void UCommonAIInputSubsystem::RegisterAgent(ACommonMoverPawn* Pawn)
+{
+	if (!IsValid(Pawn) || AgentIndices.Contains(Pawn))
+	{
+		return;
+	}
+
+	FCommonAIInputAgent& Agent = Agents.AddDefaulted_GetRef();
+	Agent.Pawn = Pawn;
+	Agent.PawnKey = Pawn;
+	Agent.Location = Pawn->GetActorLocation();
+
+	AgentIndices.Add(Pawn, Agents.Num() - 1);
+}
+
+void UCommonAIInputSubsystem::UnregisterAgent(const ACommonMoverPawn* Pawn)
+{
+	int32 AgentIdx;
+	if (!AgentIndices.RemoveAndCopyValue(Pawn, AgentIdx))
+	{
+		return;
+	}
+
+	// Fill the hole with the last agent
+	const int32 LastAgentIdx = Agents.Num() - 1;
+	if (AgentIdx != LastAgentIdx)
+	{
+		AgentIndices[Agents[LastAgentIdx].PawnKey] = AgentIdx;
+	}
+
+	Agents.RemoveAtSwap(AgentIdx, 1, EAllowShrinking::No);
+}
+
+bool UCommonAIInputSubsystem::MoveToLocation(ACommonMoverPawn* Pawn, const FVector& Goal, float AcceptanceRadius)
+{
+	if (!IsValid(Pawn))
+	{
+		return false;
+	}
+
+	UNavigationPath* Path = UNavigationSystemV1::FindPathToLocationSynchronously(this, Pawn->GetActorLocation(), Goal, Pawn);
+	if (!Path || !Path->IsValid() || Path->PathPoints.IsEmpty())
+	{
+		UE_LOG(LogMover, Verbose, TEXT("[%hs]: No path found for %s"), __FUNCTION__, *Pawn->GetName());
+		return false;
+	}
+
+	return FollowCorridor(Pawn, Path->PathPoints, AcceptanceRadius);
+}
+
+bool UCommonAIInputSubsystem::FollowCorridor(ACommonMoverPawn* Pawn, const TArray<FVector>& Corridor, float AcceptanceRadius)
+{
+	const int32* AgentIdx = AgentIndices.Find(Pawn);
+	if (!AgentIdx)
+	{
+		return false;
+	}
+
+	FCommonAIInputAgent& Agent = Agents[*AgentIdx];
+	Agent.Corridor = Corridor;
+	Agent.AcceptanceRadius = AcceptanceRadius;
+
+	// The first point is where the path started, so head for the next one
+	Agent.CorridorIndex = FMath::Min(1, Corridor.Num() - 1);
+
+	return true;
+}
+
+void UCommonAIInputSubsystem::StopMovement(ACommonMoverPawn* Pawn)
+{
+	if (const int32* AgentIdx = AgentIndices.Find(Pawn))
+	{
+		Agents[*AgentIdx].Corridor.Reset();
+		Agents[*AgentIdx].MoveInput = FVector::ZeroVector;
+	}
+}
+
+bool UCommonAIInputSubsystem::IsFollowingPath(const ACommonMoverPawn* Pawn) const
+{
+	const int32* AgentIdx = AgentIndices.Find(Pawn);
+	return AgentIdx && Agents[*AgentIdx].IsMoving();
+}
+
+bool UCommonAIInputSubsystem::GetMoveInput(const ACommonMoverPawn* Pawn, FVector& OutMoveInput) const
+{
+	const int32* AgentIdx = AgentIndices.Find(Pawn);
+	if (!AgentIdx)
+	{
+		return false;
+	}
+
+	OutMoveInput = Agents[*AgentIdx].MoveInput;
+	return true;
+}
+
+void UCommonAIInputSubsystem::SteerAgent(FCommonAIInputAgent& Agent) const
+{
+	if (!Agent.IsMoving())
+	{
+		Agent.MoveInput = FVector::ZeroVector;
+		return;
+	}
+
+	const FVector& Goal = Agent.Corridor.Last();
+
+	// Stop once we've arrived
+	const float DistanceToGoal = FVector::Dist2D(Agent.Location, Goal);
+	if (DistanceToGoal <= Agent.AcceptanceRadius)
+	{
+		Agent.Corridor.Reset();
+		Agent.MoveInput = FVector::ZeroVector;
+		return;
+	}
+
+	// Skip the corridor points we've already reached
+	while ((Agent.CorridorIndex < Agent.Corridor.Num() - 1)
+		&& (FVector::DistSquared2D(Agent.Location, Agent.Corridor[Agent.CorridorIndex]) <= FMath::Square(LookAheadDistance)))
+	{
+		++Agent.CorridorIndex;
+	}
+
+	// Aim at the point one look ahead distance along the corridor
+	FVector Target = Agent.Corridor[Agent.CorridorIndex];
+	if (Agent.CorridorIndex > 0)
+	{
+		const FVector& SegmentStart = Agent.Corridor[Agent.CorridorIndex - 1];
+		const FVector ClosestPoint = FMath::ClosestPointOnSegment(Agent.Location, SegmentStart, Target);
+		const FVector SegmentDirection = (Target - SegmentStart).GetSafeNormal2D();
+		const float DistanceToTarget = FVector::Dist2D(ClosestPoint, Target);
+
+		if (DistanceToTarget > LookAheadDistance)
+		{
+			Target = ClosestPoint + (SegmentDirection * LookAheadDistance);
+		}
+	}
+
+	// Slow down when getting close to the goal
+	const float Speed = (ArrivalSlowdownDistance > 0.0f)
+		? FMath::Clamp((DistanceToGoal - Agent.AcceptanceRadius) / ArrivalSlowdownDistance, 0.1f, 1.0f)
+		: 1.0f;
+
+	Agent.MoveInput = (Target - Agent.Location).GetSafeNormal2D() * Speed;
+}
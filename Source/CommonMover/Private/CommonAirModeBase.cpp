@@ -0,0 +1,301 @@
+// Copyright © 2024 MajorT. All Rights Reserved.
+
+
+#include "CommonAirModeBase.h"
+
+#include "CommonBlackboard.h"
+#include "CommonMoverComponent.h"
+
+#include "DefaultMovementSet/Settings/CommonLegacyMovementSettings.h"
+#include "MoveLibrary/FloorQueryUtils.h"
+#include "MoveLibrary/MovementUtils.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(CommonAirModeBase)
+
+UCommonAirModeBase::UCommonAirModeBase(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	LandingModeName = DefaultModeNames::Walking;
+}
+
+FVector UCommonAirModeBase::EvaluateTrajectory(
+	const FVector& StartLocation,
+	const FVector& StartVelocity,
+	const FVector& Gravity,
+	float Time)
+{
+	return StartLocation + (StartVelocity * Time) + (0.5f * Gravity * FMath::Square(Time));
+}
+
+int32 UCommonAirModeBase::ComputeNumTrajectorySegments(
+	const FVector& Gravity,
+	float Duration,
+	float Tolerance,
+	int32 MaxSegments)
+{
+	// A chord over a parabola segment of duration T strays at most |g| * T^2 / 8 from the curve.
+	// Splitting into N chords divides that by N^2.
+	const float MaxDeviation = Gravity.Size() * FMath::Square(Duration) * 0.125f;
+	if (MaxDeviation <= Tolerance)
+	{
+		return 1;
+	}
+
+	return FMath::Clamp(FMath::CeilToInt32(FMath::Sqrt(MaxDeviation / Tolerance)), 1, MaxSegments);
+}
+
+bool UCommonAirModeBase::CanLandWithVelocity(const FVector& Velocity, const FVector& UpDirection)
+{
+	// Only moving down onto a surface counts as landing
+	return FVector::DotProduct(Velocity, UpDirection) <= 0.0f;
+}
+
+FVector UCommonAirModeBase::ComputeSurfaceSlideVelocity(const FVector& Velocity, const FVector& HitNormal)
+{
+	// Lose the velocity going into the surface
+	if (FVector::DotProduct(Velocity, HitNormal) < 0.0f)
+	{
+		return FVector::VectorPlaneProject(Velocity, HitNormal);
+	}
+
+	return Velocity;
+}
+
+void UCommonAirModeBase::PreMove(FMoverTickEndData& OutputState)
+{
+	Super::PreMove(OutputState);
+
+	// Record the time of the jump that launched us
+	if (KinematicInputs && KinematicInputs->bIsJumpJustPressed
+		&& FVector::DotProduct(ProposedMove->LinearVelocity, MutableMoverComponent->GetUpDirection()) > 0.0f)
+	{
+		SimBlackboard->Set(CommonBlackboard::LastJumpTime, CurrentSimulationTime);
+	}
+}
+
+void UCommonAirModeBase::ApplyMovement(FMoverTickEndData& OutputState)
+{
+	// We're not standing on anything while airborne
+	SimBlackboard->Invalidate(CommonBlackboard::LastFloorResult);
+	SimBlackboard->Invalidate(CommonBlackboard::LastFoundDynamicMovementBase);
+
+	// Initialize the move data
+	FCommonMoveData AirData;
+	AirData.MoveRecord.SetDeltaSeconds(DeltaTime);
+
+	// Calculate the target orientation for the following moves
+	CalculateOrientationChange(AirData.TargetOrientQuat);
+	if (SettingsSnapshot.bShouldRemainVertical)
+	{
+		AirData.TargetOrientQuat = FRotationMatrix::MakeFromZX(MutableMoverComponent->GetUpDirection(), AirData.TargetOrientQuat.GetForwardVector()).ToQuat();
+	}
+
+	// Once we've reached terminal velocity, we stop accelerating along gravity
+	FVector StartVelocity = ProposedMove->LinearVelocity;
+	FVector Gravity = MutableMoverComponent->GetGravityAcceleration();
+	const FVector GravityDir = Gravity.GetSafeNormal();
+
+	const float FallSpeed = FVector::DotProduct(StartVelocity, GravityDir);
+	if (FallSpeed >= TerminalVerticalSpeed)
+	{
+		StartVelocity -= GravityDir * (FallSpeed - TerminalVerticalSpeed);
+		Gravity = FVector::ZeroVector;
+	}
+	else
+	{
+		// Don't gain more speed this frame than it takes to reach terminal velocity.
+		// Weakening gravity keeps the trajectory a single parabola that ends exactly at terminal velocity.
+		const float FrameSpeedGain = Gravity.Size() * DeltaTime;
+		const float MaxSpeedGain = TerminalVerticalSpeed - FallSpeed;
+		if (FrameSpeedGain > MaxSpeedGain)
+		{
+			Gravity *= MaxSpeedGain / FrameSpeedGain;
+		}
+	}
+
+	const FVector StartLocation = MovingComponentSet.UpdatedComponent->GetComponentLocation();
+
+	// Sweep along the trajectory
+	const bool bHitSomething = ApplyTrajectoryMove(AirData, StartVelocity, Gravity);
+
+	// The velocity at the time we stopped, from the analytic solution rather than the swept chords
+	FVector FinalVelocity = StartVelocity + (Gravity * (DeltaTime * AirData.PercentTimeAppliedSoFar));
+
+	if (bHitSomething)
+	{
+		// Did we land on something?
+		if (HandleLanding(OutputState, AirData, FinalVelocity))
+		{
+			// Handle landing captured our output state, so we can return
+			return;
+		}
+
+		// Slide along whatever we hit for the rest of the frame
+		const FVector TrajectoryEnd = EvaluateTrajectory(StartLocation, StartVelocity, Gravity, DeltaTime);
+		ApplySlideAlongSurface(AirData, TrajectoryEnd, FinalVelocity);
+
+		// Gravity keeps acting for the rest of the frame
+		FinalVelocity += Gravity * (DeltaTime * (1.0f - AirData.PercentTimeAppliedSoFar));
+	}
+
+	// Sliding can turn sideways speed into falling speed, so clamp the result as well
+	const float FinalFallSpeed = FVector::DotProduct(FinalVelocity, GravityDir);
+	if (FinalFallSpeed > TerminalVerticalSpeed)
+	{
+		FinalVelocity -= GravityDir * (FinalFallSpeed - TerminalVerticalSpeed);
+	}
+
+	// Capture the final movement state
+	CaptureFinalState(FinalVelocity);
+}
+
+bool UCommonAirModeBase::ApplyTrajectoryMove(FCommonMoveData& AirData, const FVector& StartVelocity, const FVector& Gravity)
+{
+	const FVector StartLocation = MovingComponentSet.UpdatedComponent->GetComponentLocation();
+	const int32 NumSegments = ComputeNumTrajectorySegments(Gravity, DeltaTime, TrajectoryTolerance, MaxTrajectorySegments);
+
+	AirData.OriginalMoveDelta = EvaluateTrajectory(StartLocation, StartVelocity, Gravity, DeltaTime) - StartLocation;
+
+	// Sweep each chord of the parabola
+	FVector SegmentStart = StartLocation;
+	for (int32 SegmentIdx = 1; SegmentIdx <= NumSegments; ++SegmentIdx)
+	{
+		const float SegmentEndPct = static_cast<float>(SegmentIdx) / NumSegments;
+		const FVector SegmentEnd = EvaluateTrajectory(StartLocation, StartVelocity, Gravity, DeltaTime * SegmentEndPct);
+
+		AirData.CurrentMoveDelta = SegmentEnd - SegmentStart;
+
+		++AirData.NumSweeps;
+		UMovementUtils::TrySafeMoveUpdatedComponent(
+			MovingComponentSet,
+			AirData.CurrentMoveDelta,
+			AirData.TargetOrientQuat,
+			true,
+			AirData.MoveHitResult,
+			ETeleportType::None,
+			AirData.MoveRecord);
+
+		if (AirData.MoveHitResult.IsValidBlockingHit())
+		{
+			// Stop where the segment got blocked
+			const float SegmentStartPct = static_cast<float>(SegmentIdx - 1) / NumSegments;
+			AirData.PercentTimeAppliedSoFar = SegmentStartPct + ((SegmentEndPct - SegmentStartPct) * AirData.MoveHitResult.Time);
+
+#if ENABLE_VISUAL_LOG
+			//@TODO: VLOG
+#endif
+
+			return true;
+		}
+
+		SegmentStart = SegmentEnd;
+	}
+
+	AirData.PercentTimeAppliedSoFar = 1.0f;
+	return false;
+}
+
+bool UCommonAirModeBase::HandleLanding(FMoverTickEndData& OutputState, FCommonMoveData& AirData, const FVector& LandingVelocity)
+{
+	const FVector UpDirection = MutableMoverComponent->GetUpDirection();
+
+	// Only moving down onto a walkable surface counts as landing
+	if (!CanLandWithVelocity(LandingVelocity, UpDirection)
+		|| !UFloorQueryUtils::IsHitSurfaceWalkable(AirData.MoveHitResult, UpDirection, SettingsSnapshot.MaxWalkSlopeCosine))
+	{
+		return false;
+	}
+
+	// Confirm the floor with a single probe
+	FFloorCheckResult LandingFloor;
+	++AirData.NumSweeps;
+	UFloorQueryUtils::FindFloor(
+		MovingComponentSet,
+		SettingsSnapshot.FloorSweepDistance,
+		SettingsSnapshot.MaxWalkSlopeCosine,
+		MovingComponentSet.UpdatedPrimitive->GetComponentLocation(),
+		LandingFloor);
+
+	if (!LandingFloor.IsWalkableFloor())
+	{
+		return false;
+	}
+
+	// Hand the rest of the frame to the landing mode
+	OutputState.MovementEndState.NextModeName = GetLandingModeName();
+	OutputState.MovementEndState.RemainingMs = DeltaMs * (1.0f - AirData.PercentTimeAppliedSoFar);
+	AirData.MoveRecord.SetDeltaSeconds(DeltaTime * AirData.PercentTimeAppliedSoFar);
+
+	// Let the ground mode start from this floor without searching for it again
+	SimBlackboard->Set(CommonBlackboard::LastFloorResult, LandingFloor);
+
+	// Keep only the velocity along the floor
+	CaptureFinalState(FVector::VectorPlaneProject(LandingVelocity, UpDirection));
+
+	if (!bIsResimulating)
+	{
+		MutableMoverComponent->OnLanded(OutputState.MovementEndState.NextModeName, LandingFloor.HitResult);
+	}
+
+#if ENABLE_VISUAL_LOG
+	//@TODO: VLOG
+#endif
+
+	return true;
+}
+
+bool UCommonAirModeBase::ApplySlideAlongSurface(FCommonMoveData& AirData, const FVector& TrajectoryEnd, FVector& InOutVelocity)
+{
+	if (!AirData.MoveHitResult.IsValidBlockingHit())
+	{
+		return false;
+	}
+
+	// Tell the mover component to handle the impact
+	if (!bIsResimulating)
+	{
+		FMoverOnImpactParams ImpactParams(DefaultModeNames::Falling, AirData.MoveHitResult, AirData.OriginalMoveDelta);
+		MutableMoverComponent->HandleImpact(ImpactParams);
+	}
+
+	// Slide towards where the trajectory would have taken us
+	const FVector RemainingDelta = TrajectoryEnd - MovingComponentSet.UpdatedComponent->GetComponentLocation();
+	const FVector HitNormal = AirData.MoveHitResult.Normal;
+
+	++AirData.NumSweeps;
+	const float SlideAmount = UMovementUtils::TryMoveToSlideAlongSurface(
+		MovingComponentSet,
+		RemainingDelta,
+		1.0f,
+		AirData.TargetOrientQuat,
+		HitNormal,
+		AirData.MoveHitResult,
+		true,
+		AirData.MoveRecord);
+
+	// Update the time percentage
+	AirData.PercentTimeAppliedSoFar = UpdateTimePercentAppliedSoFar(AirData.PercentTimeAppliedSoFar, SlideAmount);
+
+	InOutVelocity = ComputeSurfaceSlideVelocity(InOutVelocity, HitNormal);
+
+#if ENABLE_VISUAL_LOG
+	//@TODO: VLOG
+#endif
+
+	return true;
+}
+
+void UCommonAirModeBase::CaptureFinalState(const FVector& FinalVelocity) const
+{
+	OutDefaultSyncState->SetTransforms_WorldSpace( MovingComponentSet.UpdatedComponent->GetComponentLocation(),
+											  MovingComponentSet.UpdatedComponent->GetComponentRotation(),
+											  FinalVelocity,
+											  nullptr);	// no movement base while airborne
+
+	MovingComponentSet.UpdatedComponent->ComponentVelocity = FinalVelocity;
+}
+
+const FName& UCommonAirModeBase::GetLandingModeName() const
+{
+	return LandingModeName;
+}
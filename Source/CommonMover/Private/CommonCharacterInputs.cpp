@@ -0,0 +1,119 @@
+// Copyright © 2024 MajorT. All Rights Reserved.
+
+
+#include "CommonCharacterInputs.h"
+
+#include "Engine/NetSerialization.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(CommonCharacterInputs)
+
+namespace CommonCharacterInputFlags
+{
+	constexpr uint8 JumpJustPressed = 1 << 0;
+	constexpr uint8 JumpPressed = 1 << 1;
+	constexpr uint8 HasMoveInput = 1 << 2;
+	constexpr uint8 HasOrientationIntent = 1 << 3;
+	constexpr uint8 HasSuggestedMode = 1 << 4;
+	constexpr uint8 UsingMovementBase = 1 << 5;
+
+	constexpr uint32 NumBits = 6;
+
+	/** Upper bound of EMoveInputType, used to serialize it with as few bits as possible */
+	constexpr uint32 MaxMoveInputType = 8;
+}
+
+FMoverDataStructBase* FCommonCharacterInputs::Clone() const
+{
+	FCommonCharacterInputs* CopyPtr = new FCommonCharacterInputs(*this);
+	return CopyPtr;
+}
+
+bool FCommonCharacterInputs::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	using namespace CommonCharacterInputFlags;
+
+	bool bSuccess = FMoverDataStructBase::NetSerialize(Ar, Map, bOutSuccess);
+
+	// Pack the flags
+	uint8 Flags = 0;
+	if (Ar.IsSaving())
+	{
+		Flags |= bIsJumpJustPressed ? JumpJustPressed : 0;
+		Flags |= bIsJumpPressed ? JumpPressed : 0;
+		Flags |= !GetMoveInput().IsZero() ? HasMoveInput : 0;
+		Flags |= !OrientationIntent.IsZero() ? HasOrientationIntent : 0;
+		Flags |= !SuggestedMovementMode.IsNone() ? HasSuggestedMode : 0;
+		Flags |= bUsingMovementBase ? UsingMovementBase : 0;
+	}
+
+	Ar.SerializeBits(&Flags, NumBits);
+
+	bIsJumpJustPressed = (Flags & JumpJustPressed) != 0;
+	bIsJumpPressed = (Flags & JumpPressed) != 0;
+	bUsingMovementBase = (Flags & UsingMovementBase) != 0;
+
+	// Directional intents are unit length at most, velocities need the range
+	uint32 MoveInputType = static_cast<uint32>(GetMoveInputType());
+	Ar.SerializeInt(MoveInputType, MaxMoveInputType);
+
+	FVector QuantizedMoveInput = FVector::ZeroVector;
+	if (Flags & HasMoveInput)
+	{
+		QuantizedMoveInput = GetMoveInput();
+
+		if (static_cast<EMoveInputType>(MoveInputType) == EMoveInputType::Velocity)
+		{
+			bSuccess &= SerializePackedVector<10, 24>(QuantizedMoveInput, Ar);
+		}
+		else
+		{
+			bSuccess &= SerializeFixedVector<1, 16>(QuantizedMoveInput, Ar);
+		}
+	}
+
+	if (Ar.IsLoading())
+	{
+		SetMoveInput(static_cast<EMoveInputType>(MoveInputType), QuantizedMoveInput);
+	}
+
+	// Orientation intent is a direction
+	if (Flags & HasOrientationIntent)
+	{
+		bSuccess &= SerializeFixedVector<1, 16>(OrientationIntent, Ar);
+	}
+	else if (Ar.IsLoading())
+	{
+		OrientationIntent = FVector::ZeroVector;
+	}
+
+	ControlRotation.SerializeCompressedShort(Ar);
+
+	if (Flags & HasSuggestedMode)
+	{
+		Ar << SuggestedMovementMode;
+	}
+	else if (Ar.IsLoading())
+	{
+		SuggestedMovementMode = NAME_None;
+	}
+
+	// Inputs are relative to the base while we're using one, so it always has to come along
+	if (Flags & UsingMovementBase)
+	{
+		Ar << MovementBase;
+		Ar << MovementBaseBoneName;
+	}
+	else if (Ar.IsLoading())
+	{
+		MovementBase = nullptr;
+		MovementBaseBoneName = NAME_None;
+	}
+
+	bOutSuccess = bSuccess;
+	return bSuccess;
+}
+
+UScriptStruct* FCommonCharacterInputs::GetScriptStruct() const
+{
+	return FCommonCharacterInputs::StaticStruct();
+}
@@ -5,25 +5,109 @@
 
 #include "CommonBlackboard.h"
 #include "CommonMoverComponent.h"
+#include "CommonMoverStats.h"
+#include "CommonMoverWorldSubsystem.h"
+#include "Spatial/CommonMoverSpatialHashSubsystem.h"
 
+#include "LandscapeHeightfieldCollisionComponent.h"
+#include "LandscapeProxy.h"
 #include "DefaultMovementSet/Settings/CommonLegacyMovementSettings.h"
 #include "MoveLibrary/GroundMovementUtils.h"
 #include "MoveLibrary/MovementUtils.h"
+#include "Chaos/HeightField.h"
+
+namespace CommonLandscapeFloor
+{
+	/** Returns true if the landscape collision has a hole at Location, or if we can't tell (e.g. the point is outside this component) */
+	static bool IsHoleAt(const ULandscapeHeightfieldCollisionComponent& LandscapeComp, const FVector& Location)
+	{
+		if (!IsValidRef(LandscapeComp.HeightfieldRef) || !LandscapeComp.HeightfieldRef->HeightfieldGeometry)
+		{
+			return true;
+		}
+
+		// Heights are still stored where holes are painted, only the cell's material tells us it's a hole
+		const Chaos::FHeightField& HeightField = *LandscapeComp.HeightfieldRef->HeightfieldGeometry;
+		const FVector LocalPos = LandscapeComp.GetComponentTransform().InverseTransformPosition(Location) / FMath::Max(LandscapeComp.CollisionScale, UE_SMALL_NUMBER);
+		const int32 CellX = FMath::FloorToInt32(LocalPos.X);
+		const int32 CellY = FMath::FloorToInt32(LocalPos.Y);
+		if (CellX < 0 || CellY < 0 || CellX >= HeightField.GetNumCols() - 1 || CellY >= HeightField.GetNumRows() - 1)
+		{
+			return true;
+		}
+
+		return HeightField.IsHole(CellX, CellY);
+	}
+}
 
 UCommonGroundModeBase::UCommonGroundModeBase(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
 }
 
+void UCommonGroundModeBase::OnRegistered(const FName ModeName)
+{
+	Super::OnRegistered(ModeName);
+
+	// Let the separation handle other pawns instead of our sweeps.
+	// Other ground modes hold the same override, so the mover component counts the holds.
+	if (bUsePawnSeparation && bIgnorePawnsInSweeps && MutableMoverComponent)
+	{
+		MutableMoverComponent->AcquireChannelOverlap(PawnSeparationChannel);
+		HeldPawnChannel = PawnSeparationChannel;
+	}
+}
+
+void UCommonGroundModeBase::OnUnregistered()
+{
+	if (HeldPawnChannel.IsSet() && MutableMoverComponent)
+	{
+		MutableMoverComponent->ReleaseChannelOverlap(HeldPawnChannel.GetValue());
+	}
+
+	HeldPawnChannel.Reset();
+
+	Super::OnUnregistered();
+}
+
+bool UCommonGroundModeBase::RefreshSettingsSnapshot()
+{
+	if (!Super::RefreshSettingsSnapshot())
+	{
+		return false;
+	}
+
+	SettingsSnapshot.MinMovementThresholdSquared = FMath::Square(MinMovementThreshold);
+	SettingsSnapshot.MinSlideDeltaSquared = FMath::Square(MinSlideDelta);
+	SettingsSnapshot.MaxKinematicBaseMoveDistanceSquared = FMath::Square(MaxKinematicBaseMoveDistance);
+
+	return true;
+}
+
+bool UCommonGroundModeBase::IsRampHit(const FHitResult& Hit, const FVector& UpDirection)
+{
+	// Hit something after moving a bit, and its surface faces up
+	return (Hit.Time > 0.0f) && (FVector::DotProduct(Hit.Normal, UpDirection) > UE_KINDA_SMALL_NUMBER);
+}
+
+FVector UCommonGroundModeBase::ComputeWallSlideDelta(const FVector& Delta, const FVector& WallNormal, const FVector& UpDirection)
+{
+	// Slide along the wall as if it was vertical, and don't move off the ground plane
+	const FVector PlanarWallNormal = FVector::VectorPlaneProject(WallNormal, UpDirection).GetSafeNormal();
+	const FVector SlideDelta = FVector::VectorPlaneProject(Delta, PlanarWallNormal);
+
+	return FVector::VectorPlaneProject(SlideDelta, UpDirection);
+}
+
 void UCommonGroundModeBase::ApplyMovement(FMoverTickEndData& OutputState)
 {
-	// Get the settings
-	const UCommonLegacyMovementSettings* CommonLegacySettings =
-		MutableMoverComponent->FindSharedSettings<UCommonLegacyMovementSettings>();
-	checkf(CommonLegacySettings, TEXT("I don't want to hardcode the CommonLegacySettings into this MovementMode, you need to add the movement settings manually or override which settings to use."));
+	// Nothing deferred or pushed yet this frame
+	bIsMoveCoalesced = false;
+	bMovedKinematicallyWithBase = false;
+	SeparationVelocity = FVector::ZeroVector;
 
 	// Ensure we have cached floor information before moving
-	ValidateFloor(CommonLegacySettings->FloorSweepDistance, CommonLegacySettings->MaxWalkSlopeCosine);
+	ValidateFloor();
 
 	// Initialize the move data
 	FCommonMoveData WalkData;
@@ -51,10 +135,16 @@ void UCommonGroundModeBase::ApplyMovement(FMoverTickEndData& OutputState)
 	WalkData.OriginalMoveDelta = ProposedMove->LinearVelocity * DeltaTime;
 	WalkData.CurrentMoveDelta = WalkData.OriginalMoveDelta;
 
+	// Get pushed out of any movers we overlap with
+	ApplyPawnSeparation(WalkData);
+
+	// Don't run the full sweep chain for tiny moves, add them up until they're worth it
+	bIsMoveCoalesced = CoalesceMicroMovement(WalkData);
+
 	const FRotator StartingOrient = StartingSyncState->GetOrientation_WorldSpace();
 	FRotator TargetOrient = StartingOrient;
 	WalkData.TargetOrientQuat = TargetOrient.Quaternion();
-	if (CommonLegacySettings->bShouldRemainVertical)
+	if (SettingsSnapshot.bShouldRemainVertical)
 	{
 		WalkData.TargetOrientQuat = FRotationMatrix::MakeFromZX(UpDirection, WalkData.TargetOrientQuat.GetForwardVector()).ToQuat();
 	}
@@ -68,46 +158,31 @@ void UCommonGroundModeBase::ApplyMovement(FMoverTickEndData& OutputState)
 		// We are about to move !
 		bDidAttemptMovement = true;
 
-		// Apply the first move.
-		// This will catch any potential collisions or initial penetration
-		bool bMovedFreely = ApplyFirstMove(WalkData);
+		// Split fast moves into substeps, so we don't skip over ramps and ledges
+		const FVector TotalMoveDelta = WalkData.OriginalMoveDelta;
+		const int32 NumSubsteps = ComputeNumSubsteps(TotalMoveDelta);
 
-		// Apply any depenetration in case we started in the frame stuck.
-		// This will include any catch-up from the first move
-		bool bDepenetration = ApplyDepenetrationOnFirstMove(WalkData);
-
-		if (!bDepenetration)
+		for (int32 SubstepIdx = 0; SubstepIdx < NumSubsteps; ++SubstepIdx)
 		{
-			// If no depenetration was done, we can check for a ramp
-			bool bMovedUpRamp = ApplyRampMove(WalkData, CommonLegacySettings->MaxWalkSlopeCosine);
+			// If we're running out of sweeps, apply everything that's left in this substep
+			const bool bIsLastSubstep = (SubstepIdx == NumSubsteps - 1) || (WalkData.NumSweeps >= MaxSweepsPerTick);
+			const float SubstepStartPct = static_cast<float>(SubstepIdx) / NumSubsteps;
+			const float SubstepPct = bIsLastSubstep ? (1.0f - SubstepStartPct) : (1.0f / NumSubsteps);
 
-			// Attempt to move up any climbable obstacles
-			bool bSteppedUp = ApplyStepUpMove(WalkData, StepUpFloorResult, CommonLegacySettings->MaxWalkSlopeCosine, CommonLegacySettings->MaxStepHeight, CommonLegacySettings->FloorSweepDistance);
+			WalkData.OriginalMoveDelta = TotalMoveDelta * SubstepPct;
+			WalkData.CurrentMoveDelta = WalkData.OriginalMoveDelta;
+			WalkData.PercentTimeAppliedSoFar = 0.0f;
 
-			// Did we fail to step up?
-			bool bSlidAlongWall = false;
-			if (bSteppedUp)
+			bool bIsStuck = false;
+			if (ApplyMoveSubstep(OutputState, WalkData, StepUpFloorResult, SubstepStartPct, SubstepPct, bIsStuck))
 			{
-				// Attempt to slide along an unclimbable obstacle
-				bSlidAlongWall = ApplySlideAlongWall(WalkData, CommonLegacySettings->MaxWalkSlopeCosine, CommonLegacySettings->MaxStepHeight);
+				// Handle falling captured our output state, so we can return
+				return;
 			}
 
-			// Search for the floor we've ended up on
-			UFloorQueryUtils::FindFloor(
-				MovingComponentSet,
-				CommonLegacySettings->FloorSweepDistance,
-				CommonLegacySettings->MaxWalkSlopeCosine,
-				MovingComponentSet.UpdatedPrimitive->GetComponentLocation(),
-				CurrentFloor);
-
-			// Adjust vertically so we remain in contact with the floor
-			bool bAdjustedToFloor = ApplyFloorHeightAdjustment(WalkData, CommonLegacySettings->MaxWalkSlopeCosine);
-
-			// Check if we're falling
-			if (HandleFalling(OutputState, WalkData.MoveRecord, CurrentFloor.HitResult, DeltaMs * WalkData.PercentTimeAppliedSoFar))
+			if (bIsStuck || bIsLastSubstep)
 			{
-				// Handle falling captured our output state, so we can return
-				return;
+				break;
 			}
 		}
 	}
@@ -115,15 +190,7 @@ void UCommonGroundModeBase::ApplyMovement(FMoverTickEndData& OutputState)
 	{
 		// We don't need to move this frame, but we may still need to adjust to the floor
 		// Search for the floor we're standing on
-		UFloorQueryUtils::FindFloor(
-			MovingComponentSet,
-			CommonLegacySettings->FloorSweepDistance,
-			CommonLegacySettings->MaxWalkSlopeCosine,
-			MovingComponentSet.UpdatedPrimitive->GetComponentLocation(),
-			CurrentFloor);
-
-		// Copy the current floor hit result
-		WalkData.MoveHitResult = CurrentFloor.HitResult;
+		QueryFloor(WalkData, CurrentFloor);
 
 		// Check if we need to adjust to depenetrate from the floor
 		bool bAdjustedToFloor = ApplyIdleCorrections(WalkData);
@@ -140,7 +207,274 @@ void UCommonGroundModeBase::ApplyMovement(FMoverTickEndData& OutputState)
 	CaptureFinalState(CurrentFloor, bDidAttemptMovement, WalkData.MoveRecord);
 }
 
-void UCommonGroundModeBase::ValidateFloor(float FloorSweepDistance, float MaxWalkableSlopeCosine)
+void UCommonGroundModeBase::ApplyExtrapolationOnly(FMoverTickEndData& OutputState)
+{
+	Super::ApplyExtrapolationOnly(OutputState);
+
+	// Extrapolating doesn't collide, so at least keep the mover on the floor instead of sinking into or floating above slopes
+	FFloorCheckResult Floor;
+	UFloorQueryUtils::FindFloor(
+		MovingComponentSet,
+		SettingsSnapshot.FloorSweepDistance,
+		SettingsSnapshot.MaxWalkSlopeCosine,
+		MovingComponentSet.UpdatedPrimitive->GetComponentLocation(),
+		Floor);
+
+	if (!Floor.IsWalkableFloor())
+	{
+		return;
+	}
+
+	FMovementRecord MoveRecord;
+	MoveRecord.SetDeltaSeconds(DeltaTime);
+	UGroundMovementUtils::TryMoveToAdjustHeightAboveFloor(
+		MovingComponentSet,
+		Floor,
+		SettingsSnapshot.MaxWalkSlopeCosine,
+		MoveRecord);
+
+	OutDefaultSyncState->SetTransforms_WorldSpace(
+		MovingComponentSet.UpdatedComponent->GetComponentLocation(),
+		MovingComponentSet.UpdatedComponent->GetComponentRotation(),
+		StartingVelocity,
+		StartingSyncState->GetMovementBase(),
+		StartingSyncState->GetMovementBaseBoneName());
+}
+
+bool UCommonGroundModeBase::ApplyMoveSubstep(
+	FMoverTickEndData& OutputState,
+	FCommonMoveData& WalkData,
+	FOptionalFloorCheckResult& StepUpFloorResult,
+	float SubstepStartPct,
+	float SubstepPct,
+	bool& bOutIsStuck)
+{
+	// Apply the first move.
+	// This will catch any potential collisions or initial penetration
+	bool bMovedFreely = ApplyFirstMove(WalkData);
+
+	// Apply any depenetration in case we started in the frame stuck.
+	// This will include any catch-up from the first move
+	bOutIsStuck = ApplyDepenetrationOnFirstMove(WalkData);
+
+	if (bOutIsStuck)
+	{
+		return false;
+	}
+
+	// Distant movers skip ramps, step ups and slides and only clamp to the ground
+	if (!ShouldUseGroundClampOnly())
+	{
+		// If no depenetration was done, we can check for a ramp
+		bool bMovedUpRamp = ApplyRampMove(WalkData);
+
+		// Attempt to move up any climbable obstacles
+		bool bSteppedUp = ApplyStepUpMove(WalkData, StepUpFloorResult);
+
+		// Did we fail to step up?
+		bool bSlidAlongWall = false;
+		if (bSteppedUp)
+		{
+			// Attempt to slide along an unclimbable obstacle
+			bSlidAlongWall = ApplySlideAlongWall(WalkData);
+		}
+	}
+
+	// Search for the floor we've ended up on
+	QueryFloor(WalkData, CurrentFloor);
+
+	// Adjust vertically so we remain in contact with the floor
+	bool bAdjustedToFloor = ApplyFloorHeightAdjustment(WalkData);
+
+	// Check if we're falling, with the time applied so far across all substeps
+	const float TimeAppliedSoFar = DeltaMs * (SubstepStartPct + (SubstepPct * WalkData.PercentTimeAppliedSoFar));
+	return HandleFalling(OutputState, WalkData.MoveRecord, CurrentFloor.HitResult, TimeAppliedSoFar);
+}
+
+bool UCommonGroundModeBase::ApplyPawnSeparation(FCommonMoveData& WalkData)
+{
+	if (!bUsePawnSeparation)
+	{
+		return false;
+	}
+
+	const UCommonMoverSpatialHashSubsystem* SpatialHash = MutableMoverComponent->GetSpatialHash();
+	UPrimitiveComponent* UpdatedPrimitive = MovingComponentSet.UpdatedPrimitive.Get();
+	if (!SpatialHash || !UpdatedPrimitive)
+	{
+		return false;
+	}
+
+	float Radius = 0.0f;
+	float HalfHeight = 0.0f;
+	UpdatedPrimitive->CalcBoundingCylinder(Radius, HalfHeight);
+
+	const FVector Location = UpdatedPrimitive->GetComponentLocation();
+	const FVector UpDirection = MutableMoverComponent->GetUpDirection();
+	const TObjectKey<UCommonMoverComponent> OwnKey(MutableMoverComponent);
+
+	FVector Push = FVector::ZeroVector;
+	int32 NumNeighbors = 0;
+
+	// Movers are rarely much wider than us, so twice our radius finds everyone we can overlap with
+	SpatialHash->ForEachMoverInRadius(Location, Radius * 2.0f, [&](const FCommonMoverSpatialEntry& Entry)
+	{
+		if (Entry.MoverKey == OwnKey || NumNeighbors >= MaxPawnSeparationNeighbors)
+		{
+			return;
+		}
+
+		// Capsules only overlap if their vertical extents do
+		const FVector ToUs = Location - Entry.Location;
+		const float VerticalDistance = FVector::DotProduct(ToUs, UpDirection);
+		if (FMath::Abs(VerticalDistance) >= (HalfHeight + Entry.HalfHeight))
+		{
+			return;
+		}
+
+		// And their radii on the ground plane
+		const FVector HorizontalToUs = ToUs - (UpDirection * VerticalDistance);
+		const float HorizontalDistance = HorizontalToUs.Size();
+		const float Overlap = (Radius + Entry.Radius) - HorizontalDistance;
+		if (Overlap <= 0.0f)
+		{
+			return;
+		}
+
+		// Standing on top of each other, so pick a side both movers agree on
+		FVector PushDirection;
+		if (HorizontalDistance > UE_KINDA_SMALL_NUMBER)
+		{
+			PushDirection = HorizontalToUs / HorizontalDistance;
+		}
+		else
+		{
+			// Our own axes differ between the two movers, so use a world axis and split it by key
+			FVector TieBreakDirection = FVector::VectorPlaneProject(FVector::ForwardVector, UpDirection).GetSafeNormal();
+			if (TieBreakDirection.IsZero())
+			{
+				TieBreakDirection = FVector::RightVector;
+			}
+
+			PushDirection = (OwnKey < Entry.MoverKey) ? TieBreakDirection : -TieBreakDirection;
+		}
+
+		// The other mover resolves the other half
+		Push += PushDirection * (Overlap * 0.5f * PawnSeparationStiffness);
+		++NumNeighbors;
+	});
+
+	if (NumNeighbors == 0)
+	{
+		return false;
+	}
+
+	Push = Push.GetClampedToMaxSize(MaxPawnSeparationSpeed * DeltaTime);
+	if (Push.IsNearlyZero())
+	{
+		return false;
+	}
+
+	WalkData.OriginalMoveDelta += Push;
+	WalkData.CurrentMoveDelta += Push;
+	SeparationVelocity = Push / DeltaTime;
+
+	INC_DWORD_STAT(STAT_CommonMover_PawnSeparationPushes);
+
+#if ENABLE_VISUAL_LOG
+	//@TODO: VLOG
+#endif
+
+	return true;
+}
+
+bool UCommonGroundModeBase::CoalesceMicroMovement(FCommonMoveData& WalkData)
+{
+	if (MinMovementThreshold <= 0.0f)
+	{
+		return false;
+	}
+
+	FCommonPendingMove PendingMove;
+	const bool bHasPendingMove = SimBlackboard->TryGet(CommonBlackboard::PendingMove, PendingMove);
+
+	// Nothing to move and nothing deferred, this is a regular idle frame
+	if (!bHasPendingMove && WalkData.OriginalMoveDelta.IsZero())
+	{
+		return false;
+	}
+
+	const FVector MoveInput = KinematicInputs ? KinematicInputs->GetMoveInput() : FVector::ZeroVector;
+	const bool bInputChanged = bHasPendingMove && !MoveInput.Equals(PendingMove.MoveInput, UE_KINDA_SMALL_NUMBER);
+
+	const FVector TotalMoveDelta = PendingMove.Delta + WalkData.OriginalMoveDelta;
+	const float TotalSeconds = PendingMove.AccumulatedSeconds + DeltaTime;
+	const int32 TotalFrames = PendingMove.NumFrames + 1;
+
+	// We stopped, or deferred long enough. Don't hold the move back any longer.
+	const bool bMustFlush = bInputChanged || WalkData.OriginalMoveDelta.IsZero() || (TotalFrames > MaxCoalescedFrames);
+
+	// Still too small, defer it to a later frame
+	if (!bMustFlush && (TotalMoveDelta.SizeSquared() < SettingsSnapshot.MinMovementThresholdSquared))
+	{
+		if (!bHasPendingMove)
+		{
+			PendingMove.MoveInput = MoveInput;
+		}
+
+		PendingMove.Delta = TotalMoveDelta;
+		PendingMove.AccumulatedSeconds = TotalSeconds;
+		PendingMove.NumFrames = TotalFrames;
+		SimBlackboard->Set(CommonBlackboard::PendingMove, PendingMove);
+
+		WalkData.OriginalMoveDelta = FVector::ZeroVector;
+		WalkData.CurrentMoveDelta = FVector::ZeroVector;
+
+		INC_DWORD_STAT(STAT_CommonMover_CoalescedMoves);
+		return true;
+	}
+
+	// Apply everything we've deferred in one go.
+	// The record covers the deferred time as well, so the resulting velocity is the average over it.
+	if (bHasPendingMove)
+	{
+		SimBlackboard->Invalidate(CommonBlackboard::PendingMove);
+
+		WalkData.OriginalMoveDelta = TotalMoveDelta;
+		WalkData.CurrentMoveDelta = TotalMoveDelta;
+		WalkData.MoveRecord.SetDeltaSeconds(TotalSeconds);
+
+		// The push is spread over the deferred time as well
+		SeparationVelocity *= DeltaTime / TotalSeconds;
+	}
+
+	return false;
+}
+
+int32 UCommonGroundModeBase::ComputeNumSubsteps(const FVector& MoveDelta) const
+{
+	if (!bUseSubstepping)
+	{
+		return 1;
+	}
+
+	// Never move further than the capsule radius in one go, so we can't skip over a ledge or the start of a ramp
+	float SubstepDistance = MaxSubstepDistance;
+	if (SubstepDistance <= 0.0f)
+	{
+		const FCollisionShape CollisionShape = MovingComponentSet.UpdatedPrimitive->GetCollisionShape();
+		SubstepDistance = CollisionShape.IsCapsule() ? CollisionShape.GetCapsuleRadius() : CollisionShape.GetExtent().X;
+	}
+
+	if (SubstepDistance <= UE_KINDA_SMALL_NUMBER)
+	{
+		return 1;
+	}
+
+	return FMath::Clamp(FMath::CeilToInt32(MoveDelta.Size() / SubstepDistance), 1, MaxSubstepsPerTick);
+}
+
+void UCommonGroundModeBase::ValidateFloor()
 {
 	// Check if we have cached floor data
 	if (!SimBlackboard->TryGet(CommonBlackboard::LastFloorResult, CurrentFloor))
@@ -148,8 +482,8 @@ void UCommonGroundModeBase::ValidateFloor(float FloorSweepDistance, float MaxWal
 		// Search for the floor data again
 		UFloorQueryUtils::FindFloor(
 			MovingComponentSet,
-			FloorSweepDistance,
-			MaxWalkableSlopeCosine,
+			SettingsSnapshot.FloorSweepDistance,
+			SettingsSnapshot.MaxWalkSlopeCosine,
 			MovingComponentSet.UpdatedPrimitive->GetComponentLocation(),
 			CurrentFloor);
 	}
@@ -164,18 +498,75 @@ void UCommonGroundModeBase::ValidateFloor(float FloorSweepDistance, float MaxWal
 
 bool UCommonGroundModeBase::ApplyDynamicFloorMovement(FMoverTickEndData& OutputState, FMovementRecord& MoveRecord)
 {
-	// If we're on a dynamic movement base, attempt to move along with whatever motion has performed since we last ticked
-	/*if (OldRelativeBase.UsesSameBase(StartingSyncState->GetMovementBase(), StartingSyncState->GetMovementBaseBoneName()))
+	// Are we still on the dynamic base we found last frame?
+	if (!OldRelativeBase.HasRelativeInfo()
+		|| !OldRelativeBase.UsesSameBase(StartingSyncState->GetMovementBase(), StartingSyncState->GetMovementBaseBoneName()))
 	{
-		return UBasedMovementUtils::TryMoveToStayWithBase(UpdatedComponent, UpdatedPrimitive, OldRelativeBase, MoveRecord, false);
-	}*/
+		return false;
+	}
 
-	return false;
+	// Read the live base transform, the base may have moved since other riders looked at it this frame
+	FVector NewBaseLocation;
+	FQuat NewBaseRotation;
+	if (!UBasedMovementUtils::GetMovementBaseTransform(OldRelativeBase.MovementBase.Get(), OldRelativeBase.BoneName, NewBaseLocation, NewBaseRotation))
+	{
+		return false;
+	}
+
+	// Nothing to do if the base didn't move
+	if (NewBaseLocation.Equals(OldRelativeBase.Location) && NewBaseRotation.Equals(OldRelativeBase.Rotation))
+	{
+		return false;
+	}
+
+	// Ride along without sweeping if we can
+	if (TryMoveKinematicallyWithBase(NewBaseLocation, NewBaseRotation))
+	{
+		return true;
+	}
+
+	// The platform moved us too far to trust, so we sweep our way there instead
+	return UBasedMovementUtils::TryMoveToStayWithBase(MovingComponentSet, OldRelativeBase, MoveRecord, false);
+}
+
+bool UCommonGroundModeBase::TryMoveKinematicallyWithBase(const FVector& NewBaseLocation, const FQuat& NewBaseRotation)
+{
+	USceneComponent* UpdatedComponent = MovingComponentSet.UpdatedComponent.Get();
+
+	const FVector OldLocation = UpdatedComponent->GetComponentLocation();
+	const FQuat OldRotation = UpdatedComponent->GetComponentQuat();
+
+	// Apply the base's frame delta to our transform
+	const FQuat DeltaRotation = NewBaseRotation * OldRelativeBase.Rotation.Inverse();
+	const FVector NewLocation = NewBaseLocation + DeltaRotation.RotateVector(OldLocation - OldRelativeBase.Location);
+
+	// Only pick up the yaw if we need to remain vertical
+	FQuat NewRotation = DeltaRotation * OldRotation;
+	if (SettingsSnapshot.bShouldRemainVertical)
+	{
+		const FVector UpDirection = MutableMoverComponent->GetUpDirection();
+		NewRotation = FRotationMatrix::MakeFromZX(UpDirection, NewRotation.GetForwardVector()).ToQuat();
+	}
+
+	// Translation carries us exactly like the base, so only the extra swing from its rotation could push us into something it didn't hit.
+	// Penetrations are resolved by the first move, or by the full floor sweep of idle riders.
+	const FVector BaseTranslation = NewBaseLocation - OldRelativeBase.Location;
+	if ((NewLocation - OldLocation - BaseTranslation).SizeSquared() > SettingsSnapshot.MaxKinematicBaseMoveDistanceSquared)
+	{
+		return false;
+	}
+
+	// Move along with the base without sweeping
+	UpdatedComponent->SetWorldLocationAndRotation(NewLocation, NewRotation, false, nullptr, ETeleportType::None);
+	bMovedKinematicallyWithBase = true;
+
+	return true;
 }
 
 bool UCommonGroundModeBase::ApplyFirstMove(FCommonMoveData& WalkData)
 {
 	// Attempt to move the full amount first
+	++WalkData.NumSweeps;
 	bool bMoved = UMovementUtils::TrySafeMoveUpdatedComponent(
 		MovingComponentSet,
 		WalkData.CurrentMoveDelta,
@@ -198,27 +589,88 @@ bool UCommonGroundModeBase::ApplyFirstMove(FCommonMoveData& WalkData)
 bool UCommonGroundModeBase::ApplyDepenetrationOnFirstMove(FCommonMoveData& WalkData)
 {
 	// Were we immediately blocked?
+	if (!WalkData.MoveHitResult.bStartPenetrating)
+	{
+		return false;
+	}
+
+	USceneComponent* UpdatedComponent = MovingComponentSet.UpdatedComponent.Get();
+
+	// Set up the component flags for the depenetration moves
+	constexpr EMoveComponentFlags IncludeBlockingOverlapsWithoutEvents = (MOVECOMP_NeverIgnoreBlockingOverlaps | MOVECOMP_DisableBlockingOverlapDispatch);
+	const EMoveComponentFlags MoveComponentFlags = (MOVECOMP_NoFlags | IncludeBlockingOverlapsWithoutEvents);
+
+	float DepenetratedDistance = 0.0f;
+	int32 Iterations = 0;
+
+	while (WalkData.MoveHitResult.bStartPenetrating
+		&& (Iterations < MaxDepenetrationIterations)
+		&& (DepenetratedDistance < MaxDepenetrationDistance))
+	{
+		++Iterations;
+
+		// Push out of the geometry, without exceeding the distance budget
+		const FVector RequestedAdjustment = UMovementUtils::ComputePenetrationAdjustment(WalkData.MoveHitResult)
+			.GetClampedToMaxSize(MaxDepenetrationDistance - DepenetratedDistance);
+
+		const FVector PreAdjustmentLocation = UpdatedComponent->GetComponentLocation();
+		UMovementUtils::TryMoveToResolvePenetration(
+			MovingComponentSet,
+			MoveComponentFlags,
+			RequestedAdjustment,
+			WalkData.MoveHitResult,
+			UpdatedComponent->GetComponentQuat(),
+			WalkData.MoveRecord);
+
+		DepenetratedDistance += FVector::Dist(PreAdjustmentLocation, UpdatedComponent->GetComponentLocation());
+		WalkData.NumSweeps += 2;
+
+		// Retry the rest of the move. This also tells us whether we're still penetrating.
+		WalkData.CurrentMoveDelta = WalkData.OriginalMoveDelta * (1.0f - WalkData.PercentTimeAppliedSoFar);
+		UMovementUtils::TrySafeMoveUpdatedComponent(
+			MovingComponentSet,
+			WalkData.CurrentMoveDelta,
+			WalkData.TargetOrientQuat,
+			true,
+			WalkData.MoveHitResult,
+			ETeleportType::None,
+			WalkData.MoveRecord);
+	}
+
+	INC_DWORD_STAT_BY(STAT_CommonMover_DepenetrationIterations, Iterations);
+
 	if (WalkData.MoveHitResult.bStartPenetrating)
 	{
-		// TODO: handle de-penetration, try moving again, etc.
+		// Still stuck, skip the rest of the stages this frame
+		INC_DWORD_STAT(STAT_CommonMover_StuckPawns);
+		UE_LOG(LogMover, Verbose, TEXT("[%hs]: %s is stuck in %s at %s after %d depenetration iterations"),
+			__FUNCTION__,
+			*GetNameSafe(UpdatedComponent->GetOwner()),
+			*GetNameSafe(WalkData.MoveHitResult.GetComponent()),
+			*UpdatedComponent->GetComponentLocation().ToCompactString(),
+			Iterations);
+
+#if ENABLE_VISUAL_LOG
+		//@TODO: VLOG
+#endif
 
 		return true;
 	}
 
+	// Update the time percentage applied by the retried move
+	WalkData.PercentTimeAppliedSoFar = UpdateTimePercentAppliedSoFar(WalkData.PercentTimeAppliedSoFar, WalkData.MoveHitResult.Time);
+
 	return false;
 }
 
-bool UCommonGroundModeBase::ApplyRampMove(
-	FCommonMoveData& WalkData,
-	float MaxWalkableSlopeCosine)
+bool UCommonGroundModeBase::ApplyRampMove(FCommonMoveData& WalkData)
 {
 	// Have we hit something that we suspect is a ramp?
 	if (WalkData.MoveHitResult.IsValidBlockingHit())
 	{
 		// Check if the hit normal is a ramp
-		if ( (WalkData.MoveHitResult.Time > 0.0f)
-			&& (WalkData.MoveHitResult.Normal.Z > UE_KINDA_SMALL_NUMBER)
-			&& (UFloorQueryUtils::IsHitSurfaceWalkable(WalkData.MoveHitResult, FVector::UpVector, MaxWalkableSlopeCosine)))
+		if (IsRampHit(WalkData.MoveHitResult, FVector::UpVector)
+			&& UFloorQueryUtils::IsHitSurfaceWalkable(WalkData.MoveHitResult, FVector::UpVector, SettingsSnapshot.MaxWalkSlopeCosine))
 		{
 			// Compute the deflected move onto the ramp and update the move delta
 			// We apply only the time remaining. (1-time applied)
@@ -226,10 +678,11 @@ bool UCommonGroundModeBase::ApplyRampMove(
 				WalkData.CurrentMoveDelta * (1.0f - WalkData.PercentTimeAppliedSoFar),
 				FVector::UpVector,
 				WalkData.MoveHitResult,
-				MaxWalkableSlopeCosine,
+				SettingsSnapshot.MaxWalkSlopeCosine,
 				CurrentFloor.bLineTrace);
 
 			// Move again onto the ramp
+			++WalkData.NumSweeps;
 			UMovementUtils::TrySafeMoveUpdatedComponent(
 				MovingComponentSet,
 				WalkData.CurrentMoveDelta,
@@ -256,27 +709,34 @@ bool UCommonGroundModeBase::ApplyRampMove(
 
 bool UCommonGroundModeBase::ApplyStepUpMove(
 	FCommonMoveData& WalkData,
-	FOptionalFloorCheckResult& StepUpFloorResult,
-	float MaxWalkableSlopeCosine,
-	float MaxStepHeight,
-	float FloorSweepDistance)
+	FOptionalFloorCheckResult& StepUpFloorResult)
 {
 	// Are we hitting something?
 	if (WalkData.MoveHitResult.IsValidBlockingHit())
 	{
 		// Is this a surface we can step up on?
+		FCommonWalkabilityCache* WalkabilityCache = GetWalkabilityCache();
 		if (UGroundMovementUtils::CanStepUpOnHitSurface(WalkData.MoveHitResult))
 		{
+			// On a known staircase we can usually skip the full step up
+			if (TryPredictiveStairStep(WalkData))
+			{
+				return false;
+			}
+
 			// Hit a barrier or unwalkable surface, try to step up and onto it
 			const FVector PreStepUpLocation = MovingComponentSet.UpdatedComponent->GetComponentLocation();
 			const FVector DownwardDir = -MutableMoverComponent->GetUpDirection();
 
+			// Up, forward and down
+			WalkData.NumSweeps += 3;
+
 			if (!UGroundMovementUtils::TryMoveToStepUp(
 				MovingComponentSet,
 				DownwardDir,
-				MaxStepHeight,
-				MaxWalkableSlopeCosine,
-				FloorSweepDistance,
+				SettingsSnapshot.MaxStepHeight,
+				SettingsSnapshot.MaxWalkSlopeCosine,
+				SettingsSnapshot.FloorSweepDistance,
 				WalkData.OriginalMoveDelta * (1.f - WalkData.PercentTimeAppliedSoFar),
 				WalkData.MoveHitResult,
 				CurrentFloor,
@@ -295,9 +755,14 @@ bool UCommonGroundModeBase::ApplyStepUpMove(
 
 				return true;
 			}
+
+			// Learn the staircase from the step we just took
+			UpdateStaircaseInfo(PreStepUpLocation, MovingComponentSet.UpdatedComponent->GetComponentLocation());
 		}
 		else if (WalkData.MoveHitResult.Component.IsValid()
-			&& !WalkData.MoveHitResult.Component.Get()->CanCharacterStepUp(Cast<APawn>(WalkData.MoveHitResult.GetActor())))
+			&& !(WalkabilityCache
+				? WalkabilityCache->CanCharacterStepUp(WalkData.MoveHitResult)
+				: WalkData.MoveHitResult.Component.Get()->CanCharacterStepUp(Cast<APawn>(WalkData.MoveHitResult.GetActor()))))
 		{
 			return true;
 		}
@@ -307,50 +772,264 @@ bool UCommonGroundModeBase::ApplyStepUpMove(
 	return false;
 }
 
-bool UCommonGroundModeBase::ApplySlideAlongWall(
-	FCommonMoveData& WalkData,
-	float MaxWalkableSlopeCosine,
-	float MaxStepHeight)
+bool UCommonGroundModeBase::TryPredictiveStairStep(FCommonMoveData& WalkData)
+{
+	if (!bUseStaircasePrediction)
+	{
+		return false;
+	}
+
+	// We need to have climbed enough matching steps. A single step doesn't give us a direction yet.
+	FCommonStaircaseInfo Staircase;
+	if (!SimBlackboard->TryGet(CommonBlackboard::LastStaircase, Staircase) || Staircase.ConsecutiveSteps < FMath::Max(StaircaseMinSteps, 2))
+	{
+		return false;
+	}
+
+	USceneComponent* UpdatedComponent = MovingComponentSet.UpdatedComponent.Get();
+	const FVector StartLocation = UpdatedComponent->GetComponentLocation();
+	const FVector UpDirection = MutableMoverComponent->GetUpDirection();
+
+	// We need to be moving up the staircase, and still be on it
+	const FVector RemainingDelta = WalkData.OriginalMoveDelta * (1.0f - WalkData.PercentTimeAppliedSoFar);
+	const FVector HorizontalDelta = FVector::VectorPlaneProject(RemainingDelta, UpDirection);
+	const FVector FromLastStep = StartLocation - Staircase.LastStepLocation;
+
+	if (FVector::DotProduct(HorizontalDelta.GetSafeNormal(), Staircase.Direction) < 0.9f
+		|| FVector::VectorPlaneProject(FromLastStep, UpDirection).SizeSquared() > FMath::Square(Staircase.Run + StaircaseTolerance))
+	{
+		return false;
+	}
+
+	// Sweep straight onto the next tread: one rise up, plus a small margin to clear the nosing, and the rest of the move forward.
+	// Never climb higher than a regular step up would. The floor adjustment will settle us onto the tread afterwards.
+	const float PredictedRise = FMath::Min(Staircase.Rise + StaircaseTolerance, SettingsSnapshot.MaxStepHeight);
+	const FVector PredictedDelta = HorizontalDelta + (UpDirection * PredictedRise);
+
+	FScopedMovementUpdate ScopedStairMovement(UpdatedComponent, EScopedUpdate::DeferredUpdates);
+	++WalkData.NumSweeps;
+
+	// Keep the sweep out of the move data until we know the prediction held, the regular step up needs the original hit otherwise
+	FHitResult StairHit;
+	FMovementRecord StairRecord;
+	StairRecord.SetDeltaSeconds(DeltaTime);
+
+	UMovementUtils::TrySafeMoveUpdatedComponent(
+		MovingComponentSet,
+		PredictedDelta,
+		WalkData.TargetOrientQuat,
+		true,
+		StairHit,
+		ETeleportType::None,
+		StairRecord);
+
+	// Anything other than clearing the step or landing on a walkable tread is a mismatch
+	if (StairHit.bStartPenetrating
+		|| (StairHit.IsValidBlockingHit() && !UFloorQueryUtils::IsHitSurfaceWalkable(StairHit, UpDirection, SettingsSnapshot.MaxWalkSlopeCosine)))
+	{
+		ScopedStairMovement.RevertMove();
+
+		// Forget the staircase, the full step up will start learning it again
+		SimBlackboard->Invalidate(CommonBlackboard::LastStaircase);
+		return false;
+	}
+
+	WalkData.MoveHitResult = StairHit;
+	WalkData.MoveRecord.Append(FMovementSubstep(MutableMoverComponent->GetMovementModeName(), StairRecord.GetTotalMoveDelta(), true));
+
+	// Update the time percentage
+	WalkData.PercentTimeAppliedSoFar = UpdateTimePercentAppliedSoFar(WalkData.PercentTimeAppliedSoFar, WalkData.MoveHitResult.Time);
+
+	Staircase.LastStepLocation = UpdatedComponent->GetComponentLocation();
+	SimBlackboard->Set(CommonBlackboard::LastStaircase, Staircase);
+
+#if ENABLE_VISUAL_LOG
+	//@TODO: VLOG
+#endif
+
+	return true;
+}
+
+void UCommonGroundModeBase::UpdateStaircaseInfo(const FVector& PreStepUpLocation, const FVector& PostStepUpLocation) const
+{
+	if (!bUseStaircasePrediction)
+	{
+		return;
+	}
+
+	FCommonStaircaseInfo Staircase;
+	const bool bHasStaircase = SimBlackboard->TryGet(CommonBlackboard::LastStaircase, Staircase);
+
+	// Measure the step we just took against the previous one
+	const FVector UpDirection = MutableMoverComponent->GetUpDirection();
+	const FVector FromLastStep = PostStepUpLocation - Staircase.LastStepLocation;
+	const FVector HorizontalFromLastStep = FVector::VectorPlaneProject(FromLastStep, UpDirection);
+
+	const float Rise = FVector::DotProduct(PostStepUpLocation - PreStepUpLocation, UpDirection);
+	const float Run = HorizontalFromLastStep.Size();
+	const FVector Direction = HorizontalFromLastStep.GetSafeNormal();
+
+	const bool bMatchesStaircase = bHasStaircase
+		&& (Rise > UE_KINDA_SMALL_NUMBER)
+		&& (FMath::Abs(FVector::DotProduct(FromLastStep, UpDirection) - Rise) <= StaircaseTolerance)
+		&& ((Staircase.ConsecutiveSteps < 2) || (FMath::Abs(Run - Staircase.Run) <= StaircaseTolerance))
+		&& (FMath::Abs(Rise - Staircase.Rise) <= StaircaseTolerance)
+		&& ((Staircase.ConsecutiveSteps < 2) || (FVector::DotProduct(Direction, Staircase.Direction) >= 0.9f));
+
+	if (bMatchesStaircase)
+	{
+		// The second step gives us the run and direction, later ones refine them
+		Staircase.Run = (Staircase.ConsecutiveSteps < 2) ? Run : FMath::Lerp(Staircase.Run, Run, 0.5f);
+		Staircase.Direction = (Staircase.ConsecutiveSteps < 2) ? Direction : (Staircase.Direction + Direction).GetSafeNormal();
+		Staircase.Rise = FMath::Lerp(Staircase.Rise, Rise, 0.5f);
+		++Staircase.ConsecutiveSteps;
+	}
+	else
+	{
+		// Start a new staircase from this step
+		Staircase = FCommonStaircaseInfo();
+		Staircase.Rise = Rise;
+		Staircase.ConsecutiveSteps = 1;
+	}
+
+	Staircase.LastStepLocation = PostStepUpLocation;
+	SimBlackboard->Set(CommonBlackboard::LastStaircase, Staircase);
+}
+
+bool UCommonGroundModeBase::ApplySlideAlongWall(FCommonMoveData& WalkData)
 {
 	// Are we hitting something?
-	if (WalkData.MoveHitResult.IsValidBlockingHit())
+	if (!WalkData.MoveHitResult.IsValidBlockingHit())
+	{
+		// Not a blocking obstacle, can't slide along
+		return false;
+	}
+
+	// Tell the mover component to handle the impact
+	if (!bIsResimulating)
 	{
-		// Tell the mover component to handle the impact
 		FMoverOnImpactParams ImpactParams(DefaultModeNames::Walking, WalkData.MoveHitResult, WalkData.OriginalMoveDelta);
 		MutableMoverComponent->HandleImpact(ImpactParams);
+	}
+
+	// The slide budget is shared by every substep of the frame
+	if (WalkData.NumSlideSweeps >= MaxSlideSweepsPerTick)
+	{
+		return false;
+	}
+
+	// Planes we've been in contact with this frame
+	TArray<FVector, TInlineAllocator<4>> ContactPlanes;
+	ContactPlanes.Add(WalkData.MoveHitResult.Normal);
+
+	// Slide along the wall
+	const float SlidePct = 1.0f - WalkData.PercentTimeAppliedSoFar;
+	const int32 StartNumSlideSweeps = WalkData.NumSlideSweeps;
+
+	float SlideAmount = UGroundMovementUtils::TryWalkToSlideAlongSurface(
+		MovingComponentSet,
+		WalkData.OriginalMoveDelta,
+		SlidePct,
+		WalkData.TargetOrientQuat,
+		WalkData.MoveHitResult.Normal,
+		WalkData.MoveHitResult,
+		true,
+		WalkData.MoveRecord,
+		SettingsSnapshot.MaxWalkSlopeCosine,
+		SettingsSnapshot.MaxStepHeight);
 
-		// Slide along the wall
-		const float SlidePct = 1.0f - WalkData.PercentTimeAppliedSoFar;
+	// Update the time percentage
+	WalkData.PercentTimeAppliedSoFar = UpdateTimePercentAppliedSoFar(WalkData.PercentTimeAppliedSoFar, SlideAmount);
 
-		float SlideAmount = UGroundMovementUtils::TryWalkToSlideAlongSurface(
+	// The slide may have adjusted against a second wall, which costs another sweep
+	WalkData.NumSlideSweeps += 2;
+
+	// Keep sliding while we hit new walls and still have somewhere to go
+	while (WalkData.MoveHitResult.IsValidBlockingHit() && (WalkData.NumSlideSweeps < MaxSlideSweepsPerTick))
+	{
+		const FVector RemainingDelta = WalkData.OriginalMoveDelta * (1.0f - WalkData.PercentTimeAppliedSoFar);
+		const FVector HitNormal = WalkData.MoveHitResult.Normal;
+
+		// Stop early if there isn't enough movement left to be worth a sweep
+		if (RemainingDelta.SizeSquared() < SettingsSnapshot.MinSlideDeltaSquared)
+		{
+			break;
+		}
+
+		// Walkable surfaces are handled by the floor adjustment
+		if (UFloorQueryUtils::IsHitSurfaceWalkable(WalkData.MoveHitResult, FVector::UpVector, SettingsSnapshot.MaxWalkSlopeCosine))
+		{
+			break;
+		}
+
+		// Slide along the new plane while staying on the ground plane
+		FVector SlideDelta = ComputeWallSlideDelta(RemainingDelta, HitNormal, FVector::UpVector);
+
+		// Only a plane we've already touched that the slide would push us back into forms a crease.
+		// Open corners let us slide along the new plane just fine, same as TwoWallAdjust.
+		const FVector* CreasePlane = ContactPlanes.FindByPredicate([&HitNormal, &SlideDelta](const FVector& Plane)
+		{
+			return (FVector::DotProduct(Plane, HitNormal) < (1.0f - UE_KINDA_SMALL_NUMBER))
+				&& (FVector::DotProduct(SlideDelta, Plane) < 0.0f);
+		});
+
+		if (CreasePlane)
+		{
+			// Wedged between two planes, so the only way forward is along the crease.
+			// For two vertical walls the crease is vertical and we simply stop instead of bouncing between them.
+			const FVector CreaseDir = FVector::CrossProduct(*CreasePlane, HitNormal).GetSafeNormal();
+			SlideDelta = CreaseDir * FVector::DotProduct(RemainingDelta, CreaseDir);
+
+			// Don't walk up steep creases. The horizontal part of the crease direction is the cosine of its climb angle.
+			if (SlideDelta.Z > 0.0f && FMath::Sqrt(1.0f - FMath::Square(CreaseDir.Z)) < SettingsSnapshot.MaxWalkSlopeCosine)
+			{
+				SlideDelta = FVector::ZeroVector;
+			}
+		}
+
+		// We may be hitting the same plane again, which doesn't need another entry
+		const bool bIsKnownPlane = ContactPlanes.ContainsByPredicate([&HitNormal](const FVector& Plane)
+		{
+			return FVector::DotProduct(Plane, HitNormal) >= (1.0f - UE_KINDA_SMALL_NUMBER);
+		});
+
+		if (!bIsKnownPlane)
+		{
+			ContactPlanes.Add(HitNormal);
+		}
+
+		if (SlideDelta.SizeSquared() < SettingsSnapshot.MinSlideDeltaSquared)
+		{
+			break;
+		}
+
+		UMovementUtils::TrySafeMoveUpdatedComponent(
 			MovingComponentSet,
-			WalkData.OriginalMoveDelta,
-			SlidePct,
+			SlideDelta,
 			WalkData.TargetOrientQuat,
-			WalkData.MoveHitResult.Normal,
-			WalkData.MoveHitResult,
 			true,
-			WalkData.MoveRecord,
-			MaxWalkableSlopeCosine,
-			MaxStepHeight);
+			WalkData.MoveHitResult,
+			ETeleportType::None,
+			WalkData.MoveRecord);
+
+		++WalkData.NumSlideSweeps;
 
 		// Update the time percentage
-		WalkData.PercentTimeAppliedSoFar = UpdateTimePercentAppliedSoFar(WalkData.PercentTimeAppliedSoFar, SlideAmount);
+		WalkData.PercentTimeAppliedSoFar = UpdateTimePercentAppliedSoFar(WalkData.PercentTimeAppliedSoFar, WalkData.MoveHitResult.Time);
+	}
+
+	const int32 NumSlideSweeps = WalkData.NumSlideSweeps - StartNumSlideSweeps;
+	INC_DWORD_STAT_BY(STAT_CommonMover_SlideSweeps, NumSlideSweeps);
+	WalkData.NumSweeps += NumSlideSweeps;
 
 #if ENABLE_VISUAL_LOG
-		//@TODO: VLOG
+	//@TODO: VLOG
 #endif
 
-		return true;
-	}
-
-	// Not a blocking obstacle, can't slide along
-	return false;
+	return true;
 }
 
-bool UCommonGroundModeBase::ApplyFloorHeightAdjustment(
-	FCommonMoveData& WalkData,
-	float MaxWalkableSlopeCosine)
+bool UCommonGroundModeBase::ApplyFloorHeightAdjustment(FCommonMoveData& WalkData)
 {
 	// Ensure we're standing on a walkable floor
 	if (CurrentFloor.IsWalkableFloor())
@@ -361,10 +1040,11 @@ bool UCommonGroundModeBase::ApplyFloorHeightAdjustment(
 #endif
 
 		// Adjust our height to match the floor
+		++WalkData.NumSweeps;
 		UGroundMovementUtils::TryMoveToAdjustHeightAboveFloor(
 			MovingComponentSet,
 			CurrentFloor,
-			MaxWalkableSlopeCosine,
+			SettingsSnapshot.MaxWalkSlopeCosine,
 			WalkData.MoveRecord);
 
 #if ENABLE_VISUAL_LOG
@@ -380,8 +1060,11 @@ bool UCommonGroundModeBase::ApplyFloorHeightAdjustment(
 
 bool UCommonGroundModeBase::ApplyIdleCorrections(FCommonMoveData& WalkData)
 {
-	if (WalkData.MoveHitResult.bStartPenetrating)
+	if (CurrentFloor.HitResult.bStartPenetrating)
 	{
+		// Only copy the floor hit when we actually need to resolve it
+		WalkData.MoveHitResult = CurrentFloor.HitResult;
+
 		// The floor check failed because it started in penetration
 		// We don't want to try to move downward because the downward sweep failed, rather we'd like to try to pop out of the floor.
 		WalkData.MoveHitResult.TraceEnd = WalkData.MoveHitResult.TraceStart + FVector(0.f, 0.f, 2.4f);
@@ -434,6 +1117,9 @@ bool UCommonGroundModeBase::HandleFalling(
 		// Update the last fall time on the blackboard
 		SimBlackboard->Set(CommonBlackboard::LastFallTime, CurrentSimulationTime);
 
+		// Anything deferred doesn't apply to the airborne mode
+		SimBlackboard->Invalidate(CommonBlackboard::PendingMove);
+
 #if ENABLE_VISUAL_LOG
 		//@TODO: VLOG
 #endif
@@ -444,6 +1130,261 @@ bool UCommonGroundModeBase::HandleFalling(
 	return false;
 }
 
+void UCommonGroundModeBase::QueryFloor(
+	FCommonMoveData& WalkData,
+	FFloorCheckResult& OutFloorResult)
+{
+	// After riding a base without a sweep, only a full sweep can tell us whether we ended up penetrating something
+	const bool bCanSkipSweep = !bMovedKinematicallyWithBase;
+
+	// Try to sample the floor directly from the landscape first
+	FFloorCheckResult CheapFloor;
+	if (bCanSkipSweep && TryFindLandscapeFloor(WalkData, CheapFloor))
+	{
+		INC_DWORD_STAT(STAT_CommonMover_FloorLandscapeSamples);
+		OutFloorResult = CheapFloor;
+	}
+	// Then try a line trace if the floor has been simple for a while
+	else if (bCanSkipSweep && TryFindSimpleFloor(WalkData, CheapFloor))
+	{
+		INC_DWORD_STAT(STAT_CommonMover_FloorLineTraces);
+		++WalkData.NumSweeps;
+		OutFloorResult = CheapFloor;
+	}
+	else
+	{
+		// Fall back to a full floor sweep
+		INC_DWORD_STAT(STAT_CommonMover_FloorSweeps);
+		++WalkData.NumSweeps;
+		UFloorQueryUtils::FindFloor(
+			MovingComponentSet,
+			SettingsSnapshot.FloorSweepDistance,
+			SettingsSnapshot.MaxWalkSlopeCosine,
+			MovingComponentSet.UpdatedPrimitive->GetComponentLocation(),
+			OutFloorResult);
+	}
+
+	// Keep track of how simple the floor is for the next queries
+	UpdateFloorSimplicity(OutFloorResult);
+}
+
+bool UCommonGroundModeBase::TryFindSimpleFloor(
+	const FCommonMoveData& WalkData,
+	FFloorCheckResult& OutFloorResult) const
+{
+	if (!bUseLineTraceOnSimpleFloors)
+	{
+		return false;
+	}
+
+	// The floor needs to have been stable for a while
+	FCommonFloorSimplicity Simplicity;
+	if (!SimBlackboard->TryGet(CommonBlackboard::FloorSimplicity, Simplicity) || Simplicity.StableFrames < SimpleFloorStableFrames)
+	{
+		return false;
+	}
+
+	// Hitting anything this frame means we're near an edge or an obstacle, so we want the sweep
+	if (WalkData.MoveHitResult.IsValidBlockingHit())
+	{
+		INC_DWORD_STAT(STAT_CommonMover_FloorLineTraceEscalations);
+		return false;
+	}
+
+	const UPrimitiveComponent* UpdatedPrimitive = MovingComponentSet.UpdatedPrimitive.Get();
+	const FCollisionShape CollisionShape = UpdatedPrimitive->GetCollisionShape();
+	if (!CollisionShape.IsCapsule())
+	{
+		return false;
+	}
+
+	// Trace down from the capsule center to the end of the floor sweep range
+	const float CapsuleHalfHeight = CollisionShape.GetCapsuleHalfHeight();
+	const FVector TraceStart = UpdatedPrimitive->GetComponentLocation();
+	const FVector TraceEnd = TraceStart - FVector(0.0f, 0.0f, CapsuleHalfHeight + SettingsSnapshot.FloorSweepDistance);
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(CommonSimpleFloorTrace), false, UpdatedPrimitive->GetOwner());
+	FCollisionResponseParams ResponseParams;
+	UpdatedPrimitive->InitSweepCollisionParams(QueryParams, ResponseParams);
+
+	FHitResult FloorHit;
+	const bool bHit = UpdatedPrimitive->GetWorld()->LineTraceSingleByChannel(
+		FloorHit,
+		TraceStart,
+		TraceEnd,
+		UpdatedPrimitive->GetCollisionObjectType(),
+		QueryParams,
+		ResponseParams);
+
+	// Escalate to a sweep on anything that doesn't look like the same flat floor at the same height
+	const float LineDist = FloorHit.Distance - CapsuleHalfHeight;
+	const float PreviousFloorDist = CurrentFloor.bLineTrace ? CurrentFloor.LineDist : CurrentFloor.FloorDist;
+	if (!bHit
+		|| FloorHit.bStartPenetrating
+		|| FloorHit.GetComponent() != Simplicity.Component.Get()
+		|| FVector::DotProduct(FloorHit.ImpactNormal, Simplicity.Normal) < SimpleFloorMinNormalZ
+		|| FMath::Abs(LineDist - PreviousFloorDist) > SimpleFloorMaxHeightChange)
+	{
+		INC_DWORD_STAT(STAT_CommonMover_FloorLineTraceEscalations);
+		return false;
+	}
+
+	const bool bIsWalkable = UFloorQueryUtils::IsHitSurfaceWalkable(FloorHit, FVector::UpVector, SettingsSnapshot.MaxWalkSlopeCosine);
+	OutFloorResult.SetFromLineTrace(FloorHit, LineDist, LineDist, bIsWalkable);
+
+	return true;
+}
+
+void UCommonGroundModeBase::UpdateFloorSimplicity(const FFloorCheckResult& FloorResult) const
+{
+	if (!bUseLineTraceOnSimpleFloors)
+	{
+		return;
+	}
+
+	const UPrimitiveComponent* FloorComponent = FloorResult.HitResult.GetComponent();
+	const FVector FloorNormal = FloorResult.HitResult.ImpactNormal;
+
+	// Only flat, static floors are simple
+	const bool bIsSimple = FloorResult.IsWalkableFloor()
+		&& IsValid(FloorComponent)
+		&& (FloorComponent->Mobility == EComponentMobility::Static)
+		&& (FloorNormal.Z >= SimpleFloorMinNormalZ);
+
+	FCommonFloorSimplicity Simplicity;
+	SimBlackboard->TryGet(CommonBlackboard::FloorSimplicity, Simplicity);
+
+	if (!bIsSimple)
+	{
+		Simplicity.Component = nullptr;
+		Simplicity.StableFrames = 0;
+	}
+	else if (Simplicity.Component.Get() == FloorComponent && FVector::DotProduct(Simplicity.Normal, FloorNormal) >= SimpleFloorMinNormalZ)
+	{
+		++Simplicity.StableFrames;
+	}
+	else
+	{
+		// Start tracking the new floor
+		Simplicity.Component = FloorComponent;
+		Simplicity.Normal = FloorNormal;
+		Simplicity.StableFrames = 1;
+	}
+
+	SimBlackboard->Set(CommonBlackboard::FloorSimplicity, Simplicity);
+}
+
+bool UCommonGroundModeBase::TryFindLandscapeFloor(
+	const FCommonMoveData& WalkData,
+	FFloorCheckResult& OutFloorResult) const
+{
+	if (!bUseAnalyticLandscapeFloor)
+	{
+		return false;
+	}
+
+	// Regularly do a full sweep so we notice anything that was placed under us
+	if ((CurrentSimulationFrame % FMath::Max(AnalyticFloorRevalidationInterval, 1)) == 0)
+	{
+		return false;
+	}
+
+	// We need to have been standing on a landscape
+	ULandscapeHeightfieldCollisionComponent* LandscapeComp = Cast<ULandscapeHeightfieldCollisionComponent>(CurrentFloor.HitResult.GetComponent());
+	if (!LandscapeComp || !CurrentFloor.IsWalkableFloor())
+	{
+		return false;
+	}
+
+	// If we bumped into anything other than the landscape, the floor could be some other geometry
+	if (WalkData.MoveHitResult.IsValidBlockingHit() && WalkData.MoveHitResult.GetComponent() != LandscapeComp)
+	{
+		return false;
+	}
+
+	ALandscapeProxy* LandscapeProxy = LandscapeComp->GetLandscapeProxy();
+	const FCollisionShape CollisionShape = MovingComponentSet.UpdatedPrimitive->GetCollisionShape();
+	if (!LandscapeProxy || !CollisionShape.IsCapsule())
+	{
+		return false;
+	}
+
+	const float CapsuleRadius = CollisionShape.GetCapsuleRadius();
+	const float CapsuleHalfHeight = CollisionShape.GetCapsuleHalfHeight();
+	const FVector Location = MovingComponentSet.UpdatedPrimitive->GetComponentLocation();
+
+	// Sample the height under the capsule and around it to build the floor plane.
+	// GetHeightAtLocation happily returns heights over painted holes, so check the collision cells first.
+	// Samples that land on another component are treated like holes too, and the sweep handles them.
+	const float SampleOffset = CapsuleRadius * 0.5f;
+	if (CommonLandscapeFloor::IsHoleAt(*LandscapeComp, Location)
+		|| CommonLandscapeFloor::IsHoleAt(*LandscapeComp, Location + FVector(SampleOffset, 0.0f, 0.0f))
+		|| CommonLandscapeFloor::IsHoleAt(*LandscapeComp, Location - FVector(SampleOffset, 0.0f, 0.0f))
+		|| CommonLandscapeFloor::IsHoleAt(*LandscapeComp, Location + FVector(0.0f, SampleOffset, 0.0f))
+		|| CommonLandscapeFloor::IsHoleAt(*LandscapeComp, Location - FVector(0.0f, SampleOffset, 0.0f)))
+	{
+		return false;
+	}
+
+	const TOptional<float> CenterHeight = LandscapeProxy->GetHeightAtLocation(Location);
+	const TOptional<float> PosXHeight = LandscapeProxy->GetHeightAtLocation(Location + FVector(SampleOffset, 0.0f, 0.0f));
+	const TOptional<float> NegXHeight = LandscapeProxy->GetHeightAtLocation(Location - FVector(SampleOffset, 0.0f, 0.0f));
+	const TOptional<float> PosYHeight = LandscapeProxy->GetHeightAtLocation(Location + FVector(0.0f, SampleOffset, 0.0f));
+	const TOptional<float> NegYHeight = LandscapeProxy->GetHeightAtLocation(Location - FVector(0.0f, SampleOffset, 0.0f));
+
+	if (!CenterHeight.IsSet() || !PosXHeight.IsSet() || !NegXHeight.IsSet() || !PosYHeight.IsSet() || !NegYHeight.IsSet())
+	{
+		return false;
+	}
+
+	// Compute the normal from the central differences
+	const float SlopeX = (PosXHeight.GetValue() - NegXHeight.GetValue()) / (2.0f * SampleOffset);
+	const float SlopeY = (PosYHeight.GetValue() - NegYHeight.GetValue()) / (2.0f * SampleOffset);
+	const FVector FloorNormal = FVector(-SlopeX, -SlopeY, 1.0f).GetSafeNormal();
+	const FVector FloorPoint(Location.X, Location.Y, CenterHeight.GetValue());
+
+	// Compute how far the bottom sphere of the capsule would travel straight down before touching the floor plane
+	const FVector SphereCenter = Location - FVector(0.0f, 0.0f, CapsuleHalfHeight - CapsuleRadius);
+	const float FloorDist = (FVector::DotProduct(SphereCenter - FloorPoint, FloorNormal) - CapsuleRadius) / FloorNormal.Z;
+
+	// Out of range, let the sweep figure out whether we're falling
+	if (FloorDist > SettingsSnapshot.FloorSweepDistance || FloorDist < -CapsuleRadius)
+	{
+		return false;
+	}
+
+	const bool bIsWalkable = (FloorNormal.Z >= SettingsSnapshot.MaxWalkSlopeCosine);
+
+	// Build the same hit the floor sweep would have produced
+	FHitResult FloorHit(1.0f);
+	FloorHit.bBlockingHit = true;
+	FloorHit.Time = FMath::Clamp(FloorDist / SettingsSnapshot.FloorSweepDistance, 0.0f, 1.0f);
+	FloorHit.Distance = FloorDist;
+	FloorHit.TraceStart = Location;
+	FloorHit.TraceEnd = Location - FVector(0.0f, 0.0f, SettingsSnapshot.FloorSweepDistance);
+	FloorHit.Location = Location - FVector(0.0f, 0.0f, FloorDist);
+	FloorHit.ImpactPoint = SphereCenter - FVector(0.0f, 0.0f, FloorDist) - (FloorNormal * CapsuleRadius);
+	FloorHit.Normal = FloorNormal;
+	FloorHit.ImpactNormal = FloorNormal;
+	FloorHit.Component = LandscapeComp;
+	FloorHit.HitObjectHandle = FActorInstanceHandle(LandscapeProxy);
+	FloorHit.PhysMaterial = CurrentFloor.HitResult.PhysMaterial;
+
+	OutFloorResult.SetFromSweep(FloorHit, FloorDist, bIsWalkable);
+	return true;
+}
+
+FCommonWalkabilityCache* UCommonGroundModeBase::GetWalkabilityCache() const
+{
+	if (!bUseWalkabilityCache)
+	{
+		return nullptr;
+	}
+
+	UCommonMoverWorldSubsystem* MoverSubsystem = UWorld::GetSubsystem<UCommonMoverWorldSubsystem>(MutableMoverComponent->GetWorld());
+	return MoverSubsystem ? &MoverSubsystem->GetWalkabilityCache() : nullptr;
+}
+
 void UCommonGroundModeBase::CaptureFinalState(const FFloorCheckResult& FloorResult, bool bDidAttemptMovement, const FMovementRecord& Record) const
 {
 	FRelativeBaseInfo PriorBaseInfo;
@@ -462,13 +1403,25 @@ void UCommonGroundModeBase::CaptureFinalState(const FFloorCheckResult& FloorResu
 
 	// TODO: Update Main/large movement record with substeps from our local record
 
+	// While a move is deferred we keep the intended velocity, so we keep accelerating from it.
+	// Being pushed apart from other pawns isn't something we should keep accelerating from either,
+	// but only the part of the push that got through ended up in the record.
+	FVector FinalVelocity = bIsMoveCoalesced ? ProposedMove->LinearVelocity : Record.GetRelevantVelocity();
+	if (!bIsMoveCoalesced && !SeparationVelocity.IsNearlyZero())
+	{
+		const float SeparationSpeed = SeparationVelocity.Size();
+		const FVector SeparationDirection = SeparationVelocity / SeparationSpeed;
+		const float AppliedSpeed = FVector::DotProduct(FinalVelocity - ProposedMove->LinearVelocity, SeparationDirection);
+		FinalVelocity -= SeparationDirection * FMath::Clamp(AppliedSpeed, 0.0f, SeparationSpeed);
+	}
+
 	if (CurrentBaseInfo.HasRelativeInfo())
 	{
 		SimBlackboard->Set(CommonBlackboard::LastFoundDynamicMovementBase, CurrentBaseInfo);
 
 		OutDefaultSyncState->SetTransforms_WorldSpace( MovingComponentSet.UpdatedComponent->GetComponentLocation(),
 												  MovingComponentSet.UpdatedComponent->GetComponentRotation(),
-												  Record.GetRelevantVelocity(),
+												  FinalVelocity,
 												  CurrentBaseInfo.MovementBase.Get(), CurrentBaseInfo.BoneName);
 	}
 	else
@@ -477,7 +1430,7 @@ void UCommonGroundModeBase::CaptureFinalState(const FFloorCheckResult& FloorResu
 
 		OutDefaultSyncState->SetTransforms_WorldSpace( MovingComponentSet.UpdatedComponent->GetComponentLocation(),
 												  MovingComponentSet.UpdatedComponent->GetComponentRotation(),
-												  Record.GetRelevantVelocity(),
+												  FinalVelocity,
 												  nullptr);	// no movement base
 	}
 
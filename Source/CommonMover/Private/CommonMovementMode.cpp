@@ -13,6 +13,9 @@ UCommonMovementMode::UCommonMovementMode(const FObjectInitializer& ObjectInitial
 	, DeltaMs(0.0f)
 	, DeltaTime(0.0f)
 	, CurrentSimulationTime(0.0f)
+	, CurrentSimulationFrame(0)
+	, SimulationLOD(ECommonMoverSimulationLOD::Full)
+	, bIsResimulating(false)
 {
 	StartingSyncState = nullptr;
 	TagsSyncState = nullptr;
@@ -22,6 +25,7 @@ UCommonMovementMode::UCommonMovementMode(const FObjectInitializer& ObjectInitial
 
 	OutDefaultSyncState = nullptr;
 	OutTagsSyncState = nullptr;
+	OutLODSyncState = nullptr;
 }
 
 void UCommonMovementMode::GenerateMove_Implementation(
@@ -62,6 +66,14 @@ void UCommonMovementMode::SimulationTick_Implementation(const FSimulationTickPar
 		return;
 	}
 
+	// Distant simulated proxies don't need the full pipeline, they just carry their state forward
+	if (SimulationLOD == ECommonMoverSimulationLOD::ExtrapolateOnly)
+	{
+		ApplyExtrapolationOnly(OutputState);
+		PostMove(OutputState);
+		return;
+	}
+
 	// Handle anything else that needs to happen before we start moving
 	PreMove(OutputState);
 
@@ -85,8 +97,11 @@ void UCommonMovementMode::SimulationTick_Implementation(const FSimulationTickPar
 
 bool UCommonMovementMode::PrepareSimulationData(const FSimulationTickParams& Params)
 {
-	// Get the mover component
-	MutableMoverComponent = Cast<UCommonMoverComponent>(GetMoverComponent());
+	// Get the mover component, it normally got cached at registration
+	if (!MutableMoverComponent)
+	{
+		MutableMoverComponent = Cast<UCommonMoverComponent>(GetMoverComponent());
+	}
 
 	if (!IsValid(MutableMoverComponent.Get()))
 	{
@@ -94,6 +109,13 @@ bool UCommonMovementMode::PrepareSimulationData(const FSimulationTickParams& Par
 		return false;
 	}
 
+	// Rebuild the settings snapshot if the settings changed
+	if (IsSettingsSnapshotOutdated() && !RefreshSettingsSnapshot())
+	{
+		UE_LOG(LogMover, Error, TEXT("[%hs]: Couldn't find the CommonLegacySettings. Add them to the mover component's shared settings manually or override which settings to use."), __FUNCTION__);
+		return false;
+	}
+
 	// Get the updated component set
 	MovingComponentSet = Params.MovingComps;
 
@@ -104,12 +126,18 @@ bool UCommonMovementMode::PrepareSimulationData(const FSimulationTickParams& Par
 		return false;
 	}
 
-	// Get the sync states
-	StartingSyncState = Params.StartState.SyncState.SyncStateCollection.FindDataByType<FMoverDefaultSyncState>();
-	TagsSyncState = Params.StartState.SyncState.SyncStateCollection.FindDataByType<FGameplayTagsSyncState>();
+	// Get the sync states from their cached slots
+	FCommonCollectionSlotCache& SlotCache = MutableMoverComponent->GetCollectionSlotCache();
+	const FMoverDataCollection& SyncStateCollection = Params.StartState.SyncState.SyncStateCollection;
+	StartingSyncState = CommonMoverCollectionUtils::FindDataByTypeCached<const FMoverDefaultSyncState>(SyncStateCollection, SlotCache.DefaultSyncState);
+	TagsSyncState = CommonMoverCollectionUtils::FindDataByTypeCached<const FGameplayTagsSyncState>(SyncStateCollection, SlotCache.TagsSyncState);
+
+	// Run at the tier recorded in the state, so resimulations match the original frame
+	const FCommonMoverLODSyncState* LODSyncState = CommonMoverCollectionUtils::FindDataByTypeCached<const FCommonMoverLODSyncState>(SyncStateCollection, SlotCache.LODSyncState);
+	SimulationLOD = LODSyncState ? LODSyncState->SimulationLOD : ECommonMoverSimulationLOD::Full;
 
 	// Get the input structs
-	KinematicInputs = Params.StartState.InputCmd.InputCollection.FindDataByType<FCharacterDefaultInputs>();
+	KinematicInputs = CommonMoverCollectionUtils::FindDataByTypeCached<const FCharacterDefaultInputs>(Params.StartState.InputCmd.InputCollection, SlotCache.DefaultInputs);
 
 	// Get the proposed move
 	ProposedMove = &Params.ProposedMove;
@@ -127,22 +155,56 @@ bool UCommonMovementMode::PrepareSimulationData(const FSimulationTickParams& Par
 	DeltaMs = Params.TimeStep.StepMs;
 	DeltaTime = Params.TimeStep.StepMs * 0.001f;
 	CurrentSimulationTime = Params.TimeStep.BaseSimTimeMs;
+	CurrentSimulationFrame = Params.TimeStep.ServerFrame;
+	bIsResimulating = Params.TimeStep.bIsResimulating;
 
 	return true;
 }
 
 void UCommonMovementMode::BuildSimulationOutputStates(FMoverTickEndData& OutputState)
 {
-	OutDefaultSyncState = &OutputState.SyncState.SyncStateCollection.FindOrAddMutableDataByType<FMoverDefaultSyncState>();
+	FCommonCollectionSlotCache& SlotCache = MutableMoverComponent->GetCollectionSlotCache();
+	FMoverDataCollection& OutSyncStateCollection = OutputState.SyncState.SyncStateCollection;
+
+	OutDefaultSyncState = &CommonMoverCollectionUtils::FindOrAddMutableDataByTypeCached<FMoverDefaultSyncState>(OutSyncStateCollection, SlotCache.OutDefaultSyncState);
 
-	OutTagsSyncState = &OutputState.SyncState.SyncStateCollection.FindOrAddMutableDataByType<FGameplayTagsSyncState>();
+	OutTagsSyncState = &CommonMoverCollectionUtils::FindOrAddMutableDataByTypeCached<FGameplayTagsSyncState>(OutSyncStateCollection, SlotCache.OutTagsSyncState);
 	OutTagsSyncState->ClearTags();
+
+	// Carry the LOD tier forward until the game thread picks another one. Movers without LOD don't carry it at all.
+	OutLODSyncState = nullptr;
+	if (MutableMoverComponent->bEnableSimulationLOD)
+	{
+		OutLODSyncState = &CommonMoverCollectionUtils::FindOrAddMutableDataByTypeCached<FCommonMoverLODSyncState>(OutSyncStateCollection, SlotCache.OutLODSyncState);
+		OutLODSyncState->SimulationLOD = SimulationLOD;
+	}
 }
 
 void UCommonMovementMode::OnRegistered(const FName ModeName)
 {
 	Super::OnRegistered(ModeName);
 
+	// Cache the mover component and get our compact mode ID
+	MutableMoverComponent = Cast<UCommonMoverComponent>(GetMoverComponent());
+	if (MutableMoverComponent)
+	{
+		ModeId = MutableMoverComponent->RegisterMovementModeId(ModeName);
+	}
+
+	// Build the settings snapshot up front
+	RefreshSettingsSnapshot();
+
+#if WITH_EDITOR
+	SettingsChangedHandle = FCoreUObjectDelegates::OnObjectPropertyChanged.AddWeakLambda(this,
+		[this](UObject* ChangedObject, FPropertyChangedEvent& PropertyChangedEvent)
+		{
+			if (ChangedObject && ((ChangedObject == SettingsSnapshot.Source.Get()) || (ChangedObject == this)))
+			{
+				InvalidateSettingsSnapshot();
+			}
+		});
+#endif
+
 #if ENABLE_VISUAL_LOG
 	REDIRECT_TO_VLOG(GetMoverComponent()->GetOwner());
 #endif
@@ -150,6 +212,15 @@ void UCommonMovementMode::OnRegistered(const FName ModeName)
 
 void UCommonMovementMode::OnUnregistered()
 {
+	ModeId = CommonMovementModeIds::Invalid;
+	MutableMoverComponent = nullptr;
+	InvalidateSettingsSnapshot();
+
+#if WITH_EDITOR
+	FCoreUObjectDelegates::OnObjectPropertyChanged.Remove(SettingsChangedHandle);
+	SettingsChangedHandle.Reset();
+#endif
+
 	Super::OnUnregistered();
 }
 
@@ -174,6 +245,36 @@ void UCommonMovementMode::PostMove(FMoverTickEndData& OutputState)
 	OutTagsSyncState->AddTag(ModeTag);
 }
 
+void UCommonMovementMode::ApplyExtrapolationOnly(FMoverTickEndData& OutputState)
+{
+	// Extrapolate along the last known velocity. Any error is corrected by the next authoritative state.
+	const FVector ExtrapolatedLocation = StartingSyncState->GetLocation_WorldSpace() + (StartingVelocity * DeltaTime);
+	const FRotator Orientation = StartingSyncState->GetOrientation_WorldSpace();
+
+	MovingComponentSet.UpdatedComponent->SetWorldLocationAndRotation(ExtrapolatedLocation, Orientation);
+	MovingComponentSet.UpdatedComponent->ComponentVelocity = StartingVelocity;
+
+	OutDefaultSyncState->SetTransforms_WorldSpace(
+		ExtrapolatedLocation,
+		Orientation,
+		StartingVelocity,
+		StartingSyncState->GetMovementBase(),
+		StartingSyncState->GetMovementBaseBoneName());
+}
+
+bool UCommonMovementMode::ShouldUseGroundClampOnly() const
+{
+	switch (SimulationLOD)
+	{
+	case ECommonMoverSimulationLOD::GroundClampOnly:
+	case ECommonMoverSimulationLOD::ExtrapolateOnly:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
 bool UCommonMovementMode::AttemptTeleport(
 	const FVector& TeleportPos,
 	const FRotator& TeleportRot,
@@ -221,6 +322,34 @@ bool UCommonMovementMode::CalculateOrientationChange(FQuat& TargetOrientQuat)
 	return TargetOrient != StartingOrient;
 }
 
+bool UCommonMovementMode::RefreshSettingsSnapshot()
+{
+	const UMoverComponent* MoverComponent = GetMoverComponent();
+	const UCommonLegacyMovementSettings* CommonLegacySettings =
+		MoverComponent ? MoverComponent->FindSharedSettings<UCommonLegacyMovementSettings>() : nullptr;
+
+	if (!CommonLegacySettings)
+	{
+		InvalidateSettingsSnapshot();
+		return false;
+	}
+
+	SettingsSnapshot.Source = CommonLegacySettings;
+	SettingsSnapshot.Revision = MutableMoverComponent ? MutableMoverComponent->GetMovementSettingsRevision() : 0;
+	SettingsSnapshot.MaxWalkSlopeCosine = CommonLegacySettings->MaxWalkSlopeCosine;
+	SettingsSnapshot.MaxStepHeight = CommonLegacySettings->MaxStepHeight;
+	SettingsSnapshot.FloorSweepDistance = CommonLegacySettings->FloorSweepDistance;
+	SettingsSnapshot.bShouldRemainVertical = CommonLegacySettings->bShouldRemainVertical;
+
+	return true;
+}
+
+bool UCommonMovementMode::IsSettingsSnapshotOutdated() const
+{
+	return !SettingsSnapshot.IsValid()
+		|| (MutableMoverComponent && (SettingsSnapshot.Revision != MutableMoverComponent->GetMovementSettingsRevision()));
+}
+
 #if ENABLE_VISUAL_LOG
 void UCommonMovementMode::GrabDebugSnapshot(FVisualLogEntry* Snapshot) const
 {
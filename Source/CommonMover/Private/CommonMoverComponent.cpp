@@ -6,12 +6,23 @@
 #include "CommonMover/Public/GameplayTagSyncState.h"
 #include "DefaultMovementSet/Settings/CommonLegacyMovementSettings.h"
 #include "MoveLibrary/FloorQueryUtils.h"
+#include "Spatial/CommonMoverSpatialHashSubsystem.h"
+#include "Backends/MoverBackendLiaison.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "TimerManager.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(CommonMoverComponent)
 
 UCommonMoverComponent::UCommonMoverComponent(const FObjectInitializer& ObjectInitializer)
 	: Super()
 {
+	// Seed the well known mode IDs, in the order of CommonMovementModeIds
+	MovementModeIdTable.Add(DefaultModeNames::Walking);
+	MovementModeIdTable.Add(DefaultModeNames::Falling);
+	MovementModeIdTable.Add(DefaultModeNames::Flying);
+	MovementModeIdTable.Add(DefaultModeNames::Swimming);
 }
 
 #if ENABLE_VISUAL_LOG
@@ -28,6 +39,33 @@ void UCommonMoverComponent::BeginPlay()
 #if ENABLE_VISUAL_LOG
 	REDIRECT_TO_VLOG(GetOwner());
 #endif
+
+	// Start updating the simulation LOD
+	// The first update is randomly delayed so the updates of many movers are spread across frames
+	if (bEnableSimulationLOD)
+	{
+		GetWorld()->GetTimerManager().SetTimer(
+			SimulationLODTimerHandle,
+			this,
+			&ThisClass::UpdateSimulationLOD,
+			LODUpdateInterval,
+			true,
+			FMath::FRandRange(0.0f, LODUpdateInterval));
+	}
+
+	RegisterInSpatialHash();
+}
+
+void UCommonMoverComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UWorld* World = GetWorld())
+	{
+		World->GetTimerManager().ClearTimer(SimulationLODTimerHandle);
+	}
+
+	UnregisterFromSpatialHash();
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void UCommonMoverComponent::OnHandleImpact(const FMoverOnImpactParams& ImpactParams)
@@ -49,6 +87,8 @@ bool UCommonMoverComponent::TeleportImmediately(
 	const FRotator& Orientation,
 	const FVector& Velocity)
 {
+	check(IsInGameThread());
+
 	bool bSuccessfullyWrote = false;
 	FMoverSyncState PendingSyncState;
 
@@ -95,6 +135,135 @@ void UCommonMoverComponent::SetMovementDisabled(bool bState)
 	bDisableMovement = true;
 }
 
+void UCommonMoverComponent::SetSimulationTickEnabled(bool bEnabled)
+{
+	SetComponentTickEnabled(bEnabled);
+
+	// The backend drives the simulation, so it has to stop ticking with us
+	if (const AActor* MyOwner = GetOwner())
+	{
+		MyOwner->ForEachComponent(false, [bEnabled](UActorComponent* Component)
+		{
+			if (Component->Implements<UMoverBackendLiaisonInterface>())
+			{
+				Component->SetComponentTickEnabled(bEnabled);
+			}
+		});
+	}
+}
+
+void UCommonMoverComponent::SetSimulationTickInterval(float TickInterval)
+{
+	SetComponentTickInterval(TickInterval);
+
+	// The backend drives the simulation, so it sets the actual step length
+	if (const AActor* MyOwner = GetOwner())
+	{
+		MyOwner->ForEachComponent(false, [TickInterval](UActorComponent* Component)
+		{
+			if (Component->Implements<UMoverBackendLiaisonInterface>())
+			{
+				Component->SetComponentTickInterval(TickInterval);
+			}
+		});
+	}
+}
+
+void UCommonMoverComponent::AcquireChannelOverlap(ECollisionChannel Channel)
+{
+	FChannelOverlapOverride& Override = ChannelOverlapOverrides.FindOrAdd(Channel);
+	if (Override.NumHolds++ > 0)
+	{
+		return;
+	}
+
+	// First hold, remember what to restore and switch to overlap
+	UPrimitiveComponent* UpdatedPrimitive = Cast<UPrimitiveComponent>(UpdatedComponent);
+	Override.Primitive = UpdatedPrimitive;
+	if (UpdatedPrimitive)
+	{
+		Override.OriginalResponse = UpdatedPrimitive->GetCollisionResponseToChannel(Channel);
+		if (Override.OriginalResponse == ECR_Block)
+		{
+			UpdatedPrimitive->SetCollisionResponseToChannel(Channel, ECR_Overlap);
+		}
+	}
+}
+
+void UCommonMoverComponent::ReleaseChannelOverlap(ECollisionChannel Channel)
+{
+	FChannelOverlapOverride* Override = ChannelOverlapOverrides.Find(Channel);
+	if (!Override || --Override->NumHolds > 0)
+	{
+		return;
+	}
+
+	// Last hold, put back whatever we replaced
+	UPrimitiveComponent* UpdatedPrimitive = Override->Primitive.Get();
+	if (UpdatedPrimitive && Override->OriginalResponse == ECR_Block)
+	{
+		UpdatedPrimitive->SetCollisionResponseToChannel(Channel, ECR_Block);
+	}
+
+	ChannelOverlapOverrides.Remove(Channel);
+}
+
+bool UCommonMoverComponent::ResetMoverState(const FVector& Location, const FRotator& Orientation, const FVector& Velocity)
+{
+	check(IsInGameThread());
+
+	// Clear the flags raised from outside the simulation
+	bIsTeleporting = false;
+	bDisableMovement = false;
+
+	// Forget everything the modes remembered about the previous life
+	if (UMoverBlackboard* MyBlackboard = GetSimBlackboard_Mutable())
+	{
+		MyBlackboard->InvalidateAll();
+	}
+
+	if (!UpdatedComponent || !BackendLiaisonComp)
+	{
+		return false;
+	}
+
+	UpdatedComponent->SetWorldLocationAndRotation(Location, Orientation, false, nullptr, ETeleportType::ResetPhysics);
+	UpdatedComponent->ComponentVelocity = Velocity;
+
+	FMoverSyncState PendingSyncState;
+	if (!BackendLiaisonComp->ReadPendingSyncState(PendingSyncState))
+	{
+		return false;
+	}
+
+	PendingSyncState.MovementMode = StartingMovementMode;
+	PendingSyncState.LayeredMoves = FLayeredMoveGroup();
+
+	if (FMoverDefaultSyncState* DefaultSync = PendingSyncState.SyncStateCollection.FindMutableDataByType<FMoverDefaultSyncState>())
+	{
+		DefaultSync->SetTransforms_WorldSpace(Location, Orientation, Velocity, nullptr);
+	}
+
+	if (FGameplayTagsSyncState* TagsSync = PendingSyncState.SyncStateCollection.FindMutableDataByType<FGameplayTagsSyncState>())
+	{
+		TagsSync->ClearTags();
+	}
+
+	if (!BackendLiaisonComp->WritePendingSyncState(PendingSyncState))
+	{
+		return false;
+	}
+
+	FinalizeFrame(&PendingSyncState, &CachedLastAuxState);
+
+	// Re-enter the starting mode, so it activates like it did on spawn
+	QueueNextMode(StartingMovementMode, true);
+
+	UpdateSpatialHashLocation(Location);
+
+	return true;
+}
+
 bool UCommonMoverComponent::IsFalling() const
 {
 	return HasGameplayTag(Mover_IsFalling, true);
@@ -169,3 +338,252 @@ FVector UCommonMoverComponent::GetGroundNormal() const
 
 	return FVector::ZeroVector;
 }
+
+ECommonMoverSimulationLOD UCommonMoverComponent::GetSimulationLOD() const
+{
+	const FCommonMoverLODSyncState* LODSyncState = GetSyncState().SyncStateCollection.FindDataByType<FCommonMoverLODSyncState>();
+	return LODSyncState ? LODSyncState->SimulationLOD : ECommonMoverSimulationLOD::Full;
+}
+
+void UCommonMoverComponent::UpdateSimulationLOD()
+{
+	// Without LOD there's no tier in the sync state at all
+	if (!bEnableSimulationLOD)
+	{
+		return;
+	}
+
+	// Player controlled movers always run the full simulation
+	const APawn* PawnOwner = Cast<APawn>(GetOwner());
+	if (PawnOwner && PawnOwner->IsPlayerControlled())
+	{
+		SetSimulationLOD(ECommonMoverSimulationLOD::Full);
+		return;
+	}
+
+	SetSimulationLOD(ComputeSimulationLOD(GetDistanceToClosestViewer()));
+}
+
+void UCommonMoverComponent::SetSimulationLOD(ECommonMoverSimulationLOD NewLOD)
+{
+	if (!BackendLiaisonComp)
+	{
+		return;
+	}
+
+	FMoverSyncState PendingSyncState;
+	if (!BackendLiaisonComp->ReadPendingSyncState(PendingSyncState))
+	{
+		return;
+	}
+
+	// The Reduced tier runs fewer, longer steps
+	const float TickInterval = (NewLOD == ECommonMoverSimulationLOD::Reduced) ? ReducedLODTickInterval : 0.0f;
+	if (!FMath::IsNearlyEqual(GetComponentTickInterval(), TickInterval))
+	{
+		SetSimulationTickInterval(TickInterval);
+	}
+
+	// Only touch the pending state when the tier actually changes
+	FCommonMoverLODSyncState& LODSyncState = PendingSyncState.SyncStateCollection.FindOrAddMutableDataByType<FCommonMoverLODSyncState>();
+	if (LODSyncState.SimulationLOD == NewLOD)
+	{
+		return;
+	}
+
+	LODSyncState.SimulationLOD = NewLOD;
+	BackendLiaisonComp->WritePendingSyncState(PendingSyncState);
+}
+
+float UCommonMoverComponent::GetDistanceToClosestViewer() const
+{
+	const UWorld* World = GetWorld();
+	if (!World || !UpdatedComponent)
+	{
+		return MAX_flt;
+	}
+
+	const FVector MoverLocation = UpdatedComponent->GetComponentLocation();
+	float ClosestDistSq = MAX_flt;
+
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PC = It->Get();
+		if (!IsValid(PC))
+		{
+			continue;
+		}
+
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		PC->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+		ClosestDistSq = FMath::Min(ClosestDistSq, FVector::DistSquared(MoverLocation, ViewLocation));
+	}
+
+	return (ClosestDistSq < MAX_flt) ? FMath::Sqrt(ClosestDistSq) : MAX_flt;
+}
+
+ECommonMoverSimulationLOD UCommonMoverComponent::ComputeSimulationLOD(float ViewerDistance) const
+{
+	// Thresholds ordered from the most to the least detailed tier
+	const float Thresholds[] = { ReducedLODDistance, GroundClampLODDistance, ExtrapolateLODDistance };
+	const int32 CurrentTier = static_cast<int32>(GetSimulationLOD());
+
+	int32 NewTier = 0;
+	for (int32 Idx = 0; Idx < UE_ARRAY_COUNT(Thresholds); ++Idx)
+	{
+		// Only step back into a more detailed tier once the viewer is clearly inside its range.
+		// This keeps movers at the border from switching tiers every update.
+		const float Threshold = (Idx < CurrentTier) ? (Thresholds[Idx] - LODHysteresisDistance) : Thresholds[Idx];
+		if (ViewerDistance > Threshold)
+		{
+			NewTier = Idx + 1;
+		}
+	}
+
+	// Only simulated proxies can skip the simulation entirely
+	ECommonMoverSimulationLOD NewLOD = static_cast<ECommonMoverSimulationLOD>(NewTier);
+	if (NewLOD == ECommonMoverSimulationLOD::ExtrapolateOnly && GetOwnerRole() != ROLE_SimulatedProxy)
+	{
+		NewLOD = ECommonMoverSimulationLOD::GroundClampOnly;
+	}
+
+	return NewLOD;
+}
+
+bool UCommonMoverComponent::PredictTrajectory(
+	const FCommonMoverPredictionParams& Params,
+	TArray<FCommonMoverPredictionSample>& OutSamples) const
+{
+	OutSamples.Reset();
+
+	FCommonMoverPredictionContext Context;
+	if (!MakePredictionContext(Context))
+	{
+		return false;
+	}
+
+	FCommonMoverPrediction::Predict(Context, Params, OutSamples);
+	return true;
+}
+
+FCommonMoverPredictionParams UCommonMoverComponent::MakePredictionParams(FVector MoveInput, float Duration) const
+{
+	FCommonMoverPredictionParams Params;
+	Params.StartLocation = UpdatedComponent ? UpdatedComponent->GetComponentLocation() : FVector::ZeroVector;
+	Params.StartVelocity = GetVelocity();
+	Params.bStartGrounded = IsOnGround();
+	Params.MoveInput = MoveInput;
+	Params.Duration = Duration;
+
+	return Params;
+}
+
+bool UCommonMoverComponent::MakePredictionContext(FCommonMoverPredictionContext& OutContext) const
+{
+	const UPrimitiveComponent* UpdatedPrimitive = Cast<UPrimitiveComponent>(UpdatedComponent);
+	const UCommonLegacyMovementSettings* CommonLegacySettings = FindSharedSettings<UCommonLegacyMovementSettings>();
+
+	if (!GetWorld() || !UpdatedPrimitive || !CommonLegacySettings)
+	{
+		UE_LOG(LogMover, Warning, TEXT("[%hs] %s has no updated primitive or legacy movement settings, can't predict its movement."), __FUNCTION__, *GetPathNameSafe(this));
+		return false;
+	}
+
+	// Collision
+	OutContext.World = GetWorld();
+	OutContext.CollisionShape = UpdatedPrimitive->GetCollisionShape();
+	OutContext.CollisionRotation = UpdatedPrimitive->GetComponentQuat();
+	OutContext.CollisionChannel = UpdatedPrimitive->GetCollisionObjectType();
+	OutContext.QueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(CommonMoverPrediction), false, GetOwner());
+	UpdatedPrimitive->InitSweepCollisionParams(OutContext.QueryParams, OutContext.ResponseParams);
+
+	// Movement
+	OutContext.GravityAcceleration = GetGravityAcceleration();
+	OutContext.UpDirection = GetUpDirection();
+	OutContext.MaxSpeed = CommonLegacySettings->MaxSpeed;
+	OutContext.Acceleration = CommonLegacySettings->Acceleration;
+	OutContext.Deceleration = CommonLegacySettings->Deceleration;
+	OutContext.AirControlPercentage = CommonLegacySettings->AirControlPercentage;
+	OutContext.MaxWalkSlopeCosine = CommonLegacySettings->MaxWalkSlopeCosine;
+	OutContext.MaxStepHeight = CommonLegacySettings->MaxStepHeight;
+	OutContext.FloorSweepDistance = CommonLegacySettings->FloorSweepDistance;
+
+	return true;
+}
+
+FCommonMovementModeId UCommonMoverComponent::RegisterMovementModeId(const FName& ModeName)
+{
+	const FCommonMovementModeId ExistingId = FindMovementModeId(ModeName);
+	if (ExistingId != CommonMovementModeIds::Invalid || ModeName.IsNone())
+	{
+		return ExistingId;
+	}
+
+	if (MovementModeIdTable.Num() >= CommonMovementModeIds::Invalid)
+	{
+		UE_LOG(LogMover, Error, TEXT("[%hs] Ran out of movement mode IDs while registering %s on %s."), __FUNCTION__, *ModeName.ToString(), *GetPathNameSafe(this));
+		return CommonMovementModeIds::Invalid;
+	}
+
+	return static_cast<FCommonMovementModeId>(MovementModeIdTable.Add(ModeName));
+}
+
+FCommonMovementModeId UCommonMoverComponent::FindMovementModeId(const FName& ModeName) const
+{
+	// A handful of modes, a linear search beats hashing here
+	const int32 ModeIdx = MovementModeIdTable.IndexOfByKey(ModeName);
+	return (ModeIdx != INDEX_NONE) ? static_cast<FCommonMovementModeId>(ModeIdx) : CommonMovementModeIds::Invalid;
+}
+
+FName UCommonMoverComponent::GetMovementModeNameById(FCommonMovementModeId ModeId) const
+{
+	return MovementModeIdTable.IsValidIndex(ModeId) ? MovementModeIdTable[ModeId] : FName(NAME_None);
+}
+
+void UCommonMoverComponent::RegisterInSpatialHash()
+{
+	UCommonMoverSpatialHashSubsystem* SpatialHashSubsystem = GetWorld()->GetSubsystem<UCommonMoverSpatialHashSubsystem>();
+	if (!bRegisterInSpatialHash || !SpatialHashSubsystem || !UpdatedComponent)
+	{
+		return;
+	}
+
+	float Radius = 0.0f;
+	float HalfHeight = 0.0f;
+	UpdatedComponent->CalcBoundingCylinder(Radius, HalfHeight);
+
+	SpatialHashSubsystem->RegisterMover(this, UpdatedComponent->GetComponentLocation(), Radius, HalfHeight);
+	SpatialHash = SpatialHashSubsystem;
+
+	OnPostFinalize.AddUniqueDynamic(this, &ThisClass::OnPostFinalizeUpdateSpatialHash);
+}
+
+void UCommonMoverComponent::UnregisterFromSpatialHash()
+{
+	if (UCommonMoverSpatialHashSubsystem* SpatialHashSubsystem = SpatialHash.Get())
+	{
+		SpatialHashSubsystem->UnregisterMover(this);
+	}
+
+	SpatialHash.Reset();
+
+	OnPostFinalize.RemoveDynamic(this, &ThisClass::OnPostFinalizeUpdateSpatialHash);
+}
+
+void UCommonMoverComponent::UpdateSpatialHashLocation(const FVector& Location)
+{
+	if (UCommonMoverSpatialHashSubsystem* SpatialHashSubsystem = SpatialHash.Get())
+	{
+		SpatialHashSubsystem->UpdateMover(this, Location);
+	}
+}
+
+void UCommonMoverComponent::OnPostFinalizeUpdateSpatialHash(const FMoverSyncState& SyncState, const FMoverAuxStateContext& AuxState)
+{
+	if (UpdatedComponent)
+	{
+		UpdateSpatialHashLocation(UpdatedComponent->GetComponentLocation());
+	}
+}
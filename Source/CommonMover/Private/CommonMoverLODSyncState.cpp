@@ -0,0 +1,45 @@
+// Copyright © 2024 MajorT. All Rights Reserved.
+
+
+#include "CommonMover/Public/CommonMoverLODSyncState.h"
+
+FCommonMoverLODSyncState::FCommonMoverLODSyncState()
+{
+}
+
+FMoverDataStructBase* FCommonMoverLODSyncState::Clone() const
+{
+	FCommonMoverLODSyncState* CopyPtr = new FCommonMoverLODSyncState(*this);
+	return CopyPtr;
+}
+
+bool FCommonMoverLODSyncState::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	bool bSuccess = FMoverDataStructBase::NetSerialize(Ar, Map, bOutSuccess);
+	Ar << SimulationLOD;
+	return bSuccess;
+}
+
+UScriptStruct* FCommonMoverLODSyncState::GetScriptStruct() const
+{
+	return FCommonMoverLODSyncState::StaticStruct();
+}
+
+void FCommonMoverLODSyncState::ToString(FAnsiStringBuilderBase& Out) const
+{
+	FMoverDataStructBase::ToString(Out);
+	Out.Appendf("SimulationLOD[%d] \n", static_cast<int32>(SimulationLOD));
+}
+
+bool FCommonMoverLODSyncState::ShouldReconcile(const FMoverDataStructBase& AuthorityState) const
+{
+	// The tier only changes how much work a frame costs, a different tier alone is no reason to correct
+	return false;
+}
+
+void FCommonMoverLODSyncState::Interpolate(const FMoverDataStructBase& From, const FMoverDataStructBase& To, float Pct)
+{
+	// Copy from authority
+	const FCommonMoverLODSyncState* AuthoritySyncState = static_cast<const FCommonMoverLODSyncState*>(&From);
+	SimulationLOD = AuthoritySyncState->SimulationLOD;
+}
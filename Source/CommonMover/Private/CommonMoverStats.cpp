@@ -0,0 +1,14 @@
+// Copyright © 2024 MajorT. All Rights Reserved.
+
+
+#include "CommonMoverStats.h"
+
+DEFINE_STAT(STAT_CommonMover_FloorSweeps);
+DEFINE_STAT(STAT_CommonMover_FloorLineTraces);
+DEFINE_STAT(STAT_CommonMover_FloorLandscapeSamples);
+DEFINE_STAT(STAT_CommonMover_FloorLineTraceEscalations);
+DEFINE_STAT(STAT_CommonMover_DepenetrationIterations);
+DEFINE_STAT(STAT_CommonMover_StuckPawns);
+DEFINE_STAT(STAT_CommonMover_SlideSweeps);
+DEFINE_STAT(STAT_CommonMover_PawnSeparationPushes);
+DEFINE_STAT(STAT_CommonMover_CoalescedMoves);
@@ -0,0 +1,13 @@
+// Copyright © 2024 MajorT. All Rights Reserved.
+
+
+#include "CommonMoverWorldSubsystem.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(CommonMoverWorldSubsystem)
+
+void UCommonMoverWorldSubsystem::Deinitialize()
+{
+	WalkabilityCache.Reset();
+
+	Super::Deinitialize();
+}
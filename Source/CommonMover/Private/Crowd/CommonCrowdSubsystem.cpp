@@ -0,0 +1,528 @@
+// Copyright © 2024 MajorT. All Rights Reserved.
+
+
+#include "Crowd/CommonCrowdSubsystem.h"
+
+#include "CommonMoverComponent.h"
+#include "EngineUtils.h"
+#include "LandscapeProxy.h"
+#include "NavigationSystem.h"
+#include "DefaultMovementSet/Settings/CommonLegacyMovementSettings.h"
+#include "Examples/CommonMoverPawn.h"
+#include "Pool/CommonMoverPawnPoolSubsystem.h"
+#include "GameFramework/PlayerController.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(CommonCrowdSubsystem)
+
+namespace CommonCrowd
+{
+	/** Number of agents integrated at once */
+	constexpr int32 SimdWidth = 4;
+}
+
+int32 FCommonCrowdAgentBuffers::Add(int32 AgentId, const FVector& Location)
+{
+	const int32 DenseIndex = Num++;
+	Reserve(Num);
+
+	PosX[DenseIndex] = Location.X;
+	PosY[DenseIndex] = Location.Y;
+	PosZ[DenseIndex] = Location.Z;
+	VelX[DenseIndex] = 0.0f;
+	VelY[DenseIndex] = 0.0f;
+	DesiredVelX[DenseIndex] = 0.0f;
+	DesiredVelY[DenseIndex] = 0.0f;
+	FloorZ[DenseIndex] = Location.Z;
+	PrevPosX[DenseIndex] = Location.X;
+	PrevPosY[DenseIndex] = Location.Y;
+	AgentIds[DenseIndex] = AgentId;
+
+	return DenseIndex;
+}
+
+int32 FCommonCrowdAgentBuffers::RemoveAtSwap(int32 DenseIndex)
+{
+	check(DenseIndex >= 0 && DenseIndex < Num);
+
+	const int32 LastIndex = --Num;
+	const int32 MovedAgentId = (DenseIndex != LastIndex) ? AgentIds[LastIndex] : INDEX_NONE;
+
+	// Move the last agent into the freed slot
+	if (DenseIndex != LastIndex)
+	{
+		PosX[DenseIndex] = PosX[LastIndex];
+		PosY[DenseIndex] = PosY[LastIndex];
+		PosZ[DenseIndex] = PosZ[LastIndex];
+		VelX[DenseIndex] = VelX[LastIndex];
+		VelY[DenseIndex] = VelY[LastIndex];
+		DesiredVelX[DenseIndex] = DesiredVelX[LastIndex];
+		DesiredVelY[DenseIndex] = DesiredVelY[LastIndex];
+		FloorZ[DenseIndex] = FloorZ[LastIndex];
+		PrevPosX[DenseIndex] = PrevPosX[LastIndex];
+		PrevPosY[DenseIndex] = PrevPosY[LastIndex];
+		AgentIds[DenseIndex] = AgentIds[LastIndex];
+		Cells[DenseIndex] = Cells[LastIndex];
+	}
+
+	// Zero out the padding so it integrates to nothing
+	VelX[LastIndex] = 0.0f;
+	VelY[LastIndex] = 0.0f;
+	DesiredVelX[LastIndex] = 0.0f;
+	DesiredVelY[LastIndex] = 0.0f;
+	AgentIds[LastIndex] = INDEX_NONE;
+
+	return MovedAgentId;
+}
+
+void FCommonCrowdAgentBuffers::Reserve(int32 NewNum)
+{
+	const int32 PaddedNum = Align(NewNum, CommonCrowd::SimdWidth);
+	if (PosX.Num() >= PaddedNum)
+	{
+		return;
+	}
+
+	// Grow geometrically so adding agents one by one doesn't reallocate every time
+	const int32 NewSize = FMath::Max(PaddedNum, PosX.Num() * 2);
+	for (TArray<float>* Array : { &PosX, &PosY, &PosZ, &VelX, &VelY, &DesiredVelX, &DesiredVelY, &FloorZ, &PrevPosX, &PrevPosY })
+	{
+		Array->SetNumZeroed(NewSize);
+	}
+
+	AgentIds.SetNum(NewSize);
+	Cells.SetNum(NewSize);
+}
+
+void UCommonCrowdSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// Use the default settings until a pawn shares its own
+	MovementSettings = NewObject<UCommonLegacyMovementSettings>(this);
+}
+
+void UCommonCrowdSubsystem::Deinitialize()
+{
+	Agents = FCommonCrowdAgentBuffers();
+	AgentIdToIndex.Empty();
+	PromotionBlockedAgents.Empty();
+	AgentCells.Empty();
+	Landscapes.Empty();
+
+	Super::Deinitialize();
+}
+
+void UCommonCrowdSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// Cache the landscapes, so height queries don't need to look for them
+	for (TActorIterator<ALandscapeProxy> It(&InWorld); It; ++It)
+	{
+		Landscapes.Add(*It);
+	}
+}
+
+bool UCommonCrowdSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCommonCrowdSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (Agents.Num == 0)
+	{
+		return;
+	}
+
+	// Move the agents on the ground plane
+	IntegrateAgents(DeltaTime);
+
+	// Place them on the floor
+	ResolveFloorHeights();
+
+	// Keep the promotion grid up to date with where they ended up
+	UpdateAgentCells();
+
+	// Hand agents over to full mover pawns when players get close
+	PromoteAgentsNearPlayers();
+}
+
+TStatId UCommonCrowdSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCommonCrowdSubsystem, STATGROUP_Tickables);
+}
+
+int32 UCommonCrowdSubsystem::AddAgent(const FVector& Location)
+{
+	const int32 AgentId = NextAgentId++;
+	const int32 DenseIndex = Agents.Add(AgentId, Location);
+	AgentIdToIndex.Add(AgentId, DenseIndex);
+
+	const FIntPoint Cell = GetAgentCell(Location.X, Location.Y);
+	Agents.Cells[DenseIndex] = Cell;
+	AgentCells.FindOrAdd(Cell).Add(AgentId);
+
+	return AgentId;
+}
+
+void UCommonCrowdSubsystem::RemoveAgent(int32 AgentId)
+{
+	int32 DenseIndex;
+	if (!AgentIdToIndex.RemoveAndCopyValue(AgentId, DenseIndex))
+	{
+		return;
+	}
+
+	PromotionBlockedAgents.Remove(AgentId);
+	RemoveFromAgentCell(Agents.Cells[DenseIndex], AgentId);
+
+	// Fix up the index of the agent that got swapped into the freed slot
+	const int32 MovedAgentId = Agents.RemoveAtSwap(DenseIndex);
+	if (MovedAgentId != INDEX_NONE)
+	{
+		AgentIdToIndex[MovedAgentId] = DenseIndex;
+	}
+}
+
+void UCommonCrowdSubsystem::SetAgentDesiredVelocity(int32 AgentId, const FVector& DesiredVelocity)
+{
+	if (const int32* DenseIndex = AgentIdToIndex.Find(AgentId))
+	{
+		Agents.DesiredVelX[*DenseIndex] = DesiredVelocity.X;
+		Agents.DesiredVelY[*DenseIndex] = DesiredVelocity.Y;
+	}
+}
+
+FVector UCommonCrowdSubsystem::GetAgentLocation(int32 AgentId) const
+{
+	if (const int32* DenseIndex = AgentIdToIndex.Find(AgentId))
+	{
+		return Agents.GetLocation(*DenseIndex);
+	}
+
+	return FVector::ZeroVector;
+}
+
+void UCommonCrowdSubsystem::SetMovementSettings(UCommonLegacyMovementSettings* InSettings)
+{
+	if (IsValid(InSettings))
+	{
+		MovementSettings = InSettings;
+	}
+}
+
+int32 UCommonCrowdSubsystem::DemotePawn(ACommonMoverPawn* Pawn)
+{
+	if (!IsValid(Pawn))
+	{
+		return INDEX_NONE;
+	}
+
+	// Keep the floor height of the pawn so the agent doesn't snap
+	const FVector Location = Pawn->GetActorLocation();
+	const FVector Velocity = Pawn->GetVelocity();
+
+	// Keep the pawn around for the next promotion
+	GetWorld()->GetSubsystem<UCommonMoverPawnPoolSubsystem>()->ReleasePawn(Pawn);
+
+	const int32 AgentId = AddAgent(Location);
+	const int32 DenseIndex = AgentIdToIndex[AgentId];
+	Agents.FloorZ[DenseIndex] = Location.Z - AgentHalfHeight;
+	Agents.VelX[DenseIndex] = Velocity.X;
+	Agents.VelY[DenseIndex] = Velocity.Y;
+
+	// Don't promote it right back on the next tick
+	PromotionBlockedAgents.Add(AgentId);
+
+	return AgentId;
+}
+
+void UCommonCrowdSubsystem::IntegrateAgents(float DeltaTime)
+{
+	// Broadcast the settings into SIMD registers
+	const VectorRegister4Float VecDeltaTime = VectorSetFloat1(DeltaTime);
+	const VectorRegister4Float VecMaxSpeedSq = VectorSetFloat1(FMath::Square(MovementSettings->MaxSpeed));
+	const VectorRegister4Float VecMaxAccelDelta = VectorSetFloat1(MovementSettings->Acceleration * DeltaTime);
+	const VectorRegister4Float VecMaxDecelDelta = VectorSetFloat1(MovementSettings->Deceleration * DeltaTime);
+	const VectorRegister4Float VecSmallNumber = VectorSetFloat1(UE_SMALL_NUMBER);
+	const VectorRegister4Float VecOne = GlobalVectorConstants::FloatOne;
+
+	float* RESTRICT PosX = Agents.PosX.GetData();
+	float* RESTRICT PosY = Agents.PosY.GetData();
+	float* RESTRICT PrevPosX = Agents.PrevPosX.GetData();
+	float* RESTRICT PrevPosY = Agents.PrevPosY.GetData();
+	float* RESTRICT VelX = Agents.VelX.GetData();
+	float* RESTRICT VelY = Agents.VelY.GetData();
+	const float* RESTRICT DesiredVelX = Agents.DesiredVelX.GetData();
+	const float* RESTRICT DesiredVelY = Agents.DesiredVelY.GetData();
+
+	// The buffers are padded to the SIMD width, so we can always process full batches
+	for (int32 Idx = 0; Idx < Agents.Num; Idx += CommonCrowd::SimdWidth)
+	{
+		VectorRegister4Float VX = VectorLoad(VelX + Idx);
+		VectorRegister4Float VY = VectorLoad(VelY + Idx);
+		VectorRegister4Float DX = VectorLoad(DesiredVelX + Idx);
+		VectorRegister4Float DY = VectorLoad(DesiredVelY + Idx);
+
+		// Clamp the desired velocity to the max speed
+		const VectorRegister4Float DesiredSpeedSq = VectorMultiplyAdd(DX, DX, VectorMultiply(DY, DY));
+		const VectorRegister4Float SpeedScale = VectorMin(VecOne, VectorSqrt(VectorDivide(VecMaxSpeedSq, VectorMax(DesiredSpeedSq, VecSmallNumber))));
+		DX = VectorMultiply(DX, SpeedScale);
+		DY = VectorMultiply(DY, SpeedScale);
+
+		// Accelerate towards the desired velocity, or decelerate if there is none
+		const VectorRegister4Float DeltaVX = VectorSubtract(DX, VX);
+		const VectorRegister4Float DeltaVY = VectorSubtract(DY, VY);
+		const VectorRegister4Float DeltaVSq = VectorMultiplyAdd(DeltaVX, DeltaVX, VectorMultiply(DeltaVY, DeltaVY));
+		const VectorRegister4Float MaxDeltaV = VectorSelect(VectorCompareGT(DesiredSpeedSq, VecSmallNumber), VecMaxAccelDelta, VecMaxDecelDelta);
+		const VectorRegister4Float StepScale = VectorMin(VecOne, VectorMultiply(MaxDeltaV, VectorReciprocalSqrt(VectorMax(DeltaVSq, VecSmallNumber))));
+
+		VX = VectorMultiplyAdd(DeltaVX, StepScale, VX);
+		VY = VectorMultiplyAdd(DeltaVY, StepScale, VY);
+
+		VectorStore(VX, VelX + Idx);
+		VectorStore(VY, VelY + Idx);
+
+		// Integrate the positions, keeping the old ones in case the floor turns out too high
+		const VectorRegister4Float PX = VectorLoad(PosX + Idx);
+		const VectorRegister4Float PY = VectorLoad(PosY + Idx);
+		VectorStore(PX, PrevPosX + Idx);
+		VectorStore(PY, PrevPosY + Idx);
+		VectorStore(VectorMultiplyAdd(VX, VecDeltaTime, PX), PosX + Idx);
+		VectorStore(VectorMultiplyAdd(VY, VecDeltaTime, PY), PosY + Idx);
+	}
+}
+
+void UCommonCrowdSubsystem::ResolveFloorHeights()
+{
+	const float MaxStepHeight = MovementSettings->MaxStepHeight;
+	const int32 NumQueries = FMath::Min(MaxHeightQueriesPerTick, Agents.Num);
+
+	// Resolve a slice of the agents every tick, round robin
+	for (int32 QueryIdx = 0; QueryIdx < NumQueries; ++QueryIdx)
+	{
+		HeightQueryCursor = (HeightQueryCursor < Agents.Num) ? HeightQueryCursor : 0;
+		const int32 Idx = HeightQueryCursor++;
+
+		float NewFloorZ;
+		if (!SampleFloorHeight(FVector(Agents.PosX[Idx], Agents.PosY[Idx], Agents.FloorZ[Idx] + MaxStepHeight), NewFloorZ))
+		{
+			continue;
+		}
+
+		// Agents can't climb more than a step, just like the ground mode.
+		// We undo this tick's move and let their desired velocity steer them away. Going back any further would make them pop.
+		if (NewFloorZ - Agents.FloorZ[Idx] > MaxStepHeight)
+		{
+			Agents.PosX[Idx] = Agents.PrevPosX[Idx];
+			Agents.PosY[Idx] = Agents.PrevPosY[Idx];
+			Agents.VelX[Idx] = 0.0f;
+			Agents.VelY[Idx] = 0.0f;
+			continue;
+		}
+
+		Agents.FloorZ[Idx] = NewFloorZ;
+	}
+
+	// Keep every agent on its last known floor
+	for (int32 Idx = 0; Idx < Agents.Num; ++Idx)
+	{
+		Agents.PosZ[Idx] = Agents.FloorZ[Idx] + AgentHalfHeight;
+	}
+}
+
+bool UCommonCrowdSubsystem::SampleFloorHeight(const FVector& Location, float& OutHeight) const
+{
+	const float MaxStepHeight = MovementSettings->MaxStepHeight;
+
+	// Landscapes can be sampled directly from their heightfield
+	TOptional<float> LandscapeHeight;
+	for (const TWeakObjectPtr<ALandscapeProxy>& Landscape : Landscapes)
+	{
+		if (const ALandscapeProxy* LandscapePtr = Landscape.Get())
+		{
+			LandscapeHeight = LandscapePtr->GetHeightAtLocation(Location);
+			if (LandscapeHeight.IsSet())
+			{
+				break;
+			}
+		}
+	}
+
+	// The landscape is what we're standing on as long as it's within a step of our floor.
+	// Further below, we may be on a bridge over it, and above us we may be in a tunnel under it. Only the navmesh knows about those.
+	if (LandscapeHeight.IsSet()
+		&& (LandscapeHeight.GetValue() <= Location.Z)
+		&& (Location.Z - LandscapeHeight.GetValue() <= 2.0f * MaxStepHeight))
+	{
+		OutHeight = LandscapeHeight.GetValue();
+		return true;
+	}
+
+	// Otherwise project onto the navmesh
+	if (const UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+	{
+		const float QueryHeight = MaxStepHeight + AgentHalfHeight;
+
+		FNavLocation NavLocation;
+		if (NavSys->ProjectPointToNavigation(Location, NavLocation, FVector(50.0f, 50.0f, QueryHeight)))
+		{
+			OutHeight = NavLocation.Location.Z;
+			return true;
+		}
+	}
+
+	// Nothing else under us, so we walked off whatever we were on, or ran into the terrain
+	if (LandscapeHeight.IsSet())
+	{
+		OutHeight = LandscapeHeight.GetValue();
+		return true;
+	}
+
+	return false;
+}
+
+FIntPoint UCommonCrowdSubsystem::GetAgentCell(float X, float Y) const
+{
+	return FIntPoint(FMath::FloorToInt32(X / AgentCellSize), FMath::FloorToInt32(Y / AgentCellSize));
+}
+
+void UCommonCrowdSubsystem::UpdateAgentCells()
+{
+	for (int32 Idx = 0; Idx < Agents.Num; ++Idx)
+	{
+		// Only touch the grid when we changed cells
+		const FIntPoint NewCell = GetAgentCell(Agents.PosX[Idx], Agents.PosY[Idx]);
+		if (NewCell != Agents.Cells[Idx])
+		{
+			RemoveFromAgentCell(Agents.Cells[Idx], Agents.AgentIds[Idx]);
+			AgentCells.FindOrAdd(NewCell).Add(Agents.AgentIds[Idx]);
+			Agents.Cells[Idx] = NewCell;
+		}
+	}
+}
+
+void UCommonCrowdSubsystem::RemoveFromAgentCell(const FIntPoint& Cell, int32 AgentId)
+{
+	if (auto* CellAgents = AgentCells.Find(Cell))
+	{
+		CellAgents->RemoveSingleSwap(AgentId);
+		if (CellAgents->IsEmpty())
+		{
+			AgentCells.Remove(Cell);
+		}
+	}
+}
+
+void UCommonCrowdSubsystem::PromoteAgentsNearPlayers()
+{
+	// Only the authority spawns pawns
+	if (!PromotionPawnClass || GetWorld()->GetNetMode() == NM_Client)
+	{
+		return;
+	}
+
+	// Gather the player locations
+	TArray<FVector, TInlineAllocator<8>> PlayerLocations;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (const APawn* PlayerPawn = It->Get() ? It->Get()->GetPawn() : nullptr)
+		{
+			PlayerLocations.Add(PlayerPawn->GetActorLocation());
+		}
+	}
+
+	if (PlayerLocations.IsEmpty())
+	{
+		return;
+	}
+
+	const float PromotionDistanceSq = FMath::Square(PromotionDistance);
+	const auto IsNearPlayer = [&PlayerLocations, PromotionDistanceSq](const FVector& AgentLocation)
+	{
+		return PlayerLocations.ContainsByPredicate([&](const FVector& PlayerLocation)
+		{
+			return FVector::DistSquared(AgentLocation, PlayerLocation) < PromotionDistanceSq;
+		});
+	};
+
+	// Demoted agents become promotable again once they're out of range
+	for (auto It = PromotionBlockedAgents.CreateIterator(); It; ++It)
+	{
+		const int32* DenseIndex = AgentIdToIndex.Find(*It);
+		if (!DenseIndex || !IsNearPlayer(Agents.GetLocation(*DenseIndex)))
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	// Only look at the cells around the players, up to the per tick budget
+	TArray<int32, TInlineAllocator<8>> AgentsToPromote;
+	for (const FVector& PlayerLocation : PlayerLocations)
+	{
+		const FIntPoint MinCell = GetAgentCell(PlayerLocation.X - PromotionDistance, PlayerLocation.Y - PromotionDistance);
+		const FIntPoint MaxCell = GetAgentCell(PlayerLocation.X + PromotionDistance, PlayerLocation.Y + PromotionDistance);
+
+		for (int32 CellX = MinCell.X; CellX <= MaxCell.X && AgentsToPromote.Num() < MaxPromotionsPerTick; ++CellX)
+		{
+			for (int32 CellY = MinCell.Y; CellY <= MaxCell.Y && AgentsToPromote.Num() < MaxPromotionsPerTick; ++CellY)
+			{
+				const auto* CellAgents = AgentCells.Find(FIntPoint(CellX, CellY));
+				if (!CellAgents)
+				{
+					continue;
+				}
+
+				for (const int32 AgentId : *CellAgents)
+				{
+					if (AgentsToPromote.Num() >= MaxPromotionsPerTick)
+					{
+						break;
+					}
+
+					const FVector AgentLocation = Agents.GetLocation(AgentIdToIndex[AgentId]);
+					if (FVector::DistSquared(AgentLocation, PlayerLocation) < PromotionDistanceSq && !PromotionBlockedAgents.Contains(AgentId))
+					{
+						AgentsToPromote.AddUnique(AgentId);
+					}
+				}
+			}
+		}
+	}
+
+	// Promoting changes the dense indices, so we do it by id
+	for (const int32 AgentId : AgentsToPromote)
+	{
+		PromoteAgent(AgentId);
+	}
+}
+
+ACommonMoverPawn* UCommonCrowdSubsystem::PromoteAgent(int32 AgentId)
+{
+	const int32* DenseIndex = AgentIdToIndex.Find(AgentId);
+	if (!DenseIndex)
+	{
+		return nullptr;
+	}
+
+	const FVector Location = Agents.GetLocation(*DenseIndex);
+	const FVector Velocity(Agents.VelX[*DenseIndex], Agents.VelY[*DenseIndex], 0.0f);
+	const FRotator Rotation = Velocity.IsNearlyZero() ? FRotator::ZeroRotator : Velocity.Rotation();
+
+	// Reuse a demoted pawn if there is one
+	UCommonMoverPawnPoolSubsystem* PawnPool = GetWorld()->GetSubsystem<UCommonMoverPawnPoolSubsystem>();
+	ACommonMoverPawn* Pawn = PawnPool->AcquirePawn(PromotionPawnClass, FTransform(Rotation, Location), Velocity);
+	if (!IsValid(Pawn))
+	{
+		UE_LOG(LogMover, Warning, TEXT("[%hs]: Couldn't spawn a pawn for crowd agent %d"), __FUNCTION__, AgentId);
+		return nullptr;
+	}
+
+	RemoveAgent(AgentId);
+	OnAgentPromoted.Broadcast(AgentId, Pawn);
+
+	return Pawn;
+}
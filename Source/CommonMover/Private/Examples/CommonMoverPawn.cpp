@@ -3,7 +3,9 @@
 
 #include "Examples/CommonMoverPawn.h"
 
+#include "CommonCharacterInputs.h"
 #include "CommonMoverComponent.h"
+#include "AI/CommonAIInputSubsystem.h"
 #include "EnhancedInputComponent.h"
 #include "Components/CapsuleComponent.h"
 
@@ -28,6 +30,10 @@ ACommonMoverPawn::ACommonMoverPawn()
 
 #if WITH_EDITORONLY_DATA
 	// Cooked builds may have some MoverComponent data missing, resulting in a non-functional actor.
+	// The optimized path builds Blueprint components from a cached property delta of the template, which doesn't
+	// deep-copy the instanced subobjects in UMoverComponent's MovementModes map and Transitions array. Those modes hold
+	// per-pawn state (settings snapshot, current floor, slot caches), so every pawn needs its own copies, and pooled
+	// pawns that are reused keep relying on them. This can't go away until the engine instances those properly.
 	bOptimizeBPComponentData = false;
 #endif
 }
@@ -43,10 +49,46 @@ void ACommonMoverPawn::SetupPlayerInputComponent(class UInputComponent* PlayerIn
 	}
 }
 
+void ACommonMoverPawn::PossessedBy(AController* NewController)
+{
+	Super::PossessedBy(NewController);
+
+	// AI controllers get their input from the batched steering
+	if (NewController && !NewController->IsPlayerController())
+	{
+		if (UCommonAIInputSubsystem* AIInput = GetWorld()->GetSubsystem<UCommonAIInputSubsystem>())
+		{
+			AIInput->RegisterAgent(this);
+		}
+	}
+}
+
+void ACommonMoverPawn::UnPossessed()
+{
+	if (UCommonAIInputSubsystem* AIInput = GetWorld()->GetSubsystem<UCommonAIInputSubsystem>())
+	{
+		AIInput->UnregisterAgent(this);
+	}
+
+	Super::UnPossessed();
+}
+
+void ACommonMoverPawn::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UCommonAIInputSubsystem* AIInput = GetWorld()->GetSubsystem<UCommonAIInputSubsystem>())
+	{
+		AIInput->UnregisterAgent(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void ACommonMoverPawn::ProduceInput_Implementation(int32 SimTimeMs, FMoverInputCmdContext& InputCmdResult)
 {
 	float DeltaMs = static_cast<float>(SimTimeMs);
-	FCharacterDefaultInputs& DefaultKinematicInputs = InputCmdResult.InputCollection.FindOrAddMutableDataByType<FCharacterDefaultInputs>();
+	FCharacterDefaultInputs& DefaultKinematicInputs = bCompressInputs
+		? InputCmdResult.InputCollection.FindOrAddMutableDataByType<FCommonCharacterInputs>()
+		: InputCmdResult.InputCollection.FindOrAddMutableDataByType<FCharacterDefaultInputs>();
 
 	static const FCharacterDefaultInputs DoNothingInput;
 
@@ -73,9 +115,18 @@ void ACommonMoverPawn::ProduceInput_Implementation(int32 SimTimeMs, FMoverInputC
 		DefaultKinematicInputs.ControlRotation = PC->GetControlRotation();
 	}
 
-	// force the forward input intent if autowalk is on
-	FVector MoveInputIntent = CachedMoveInputIntent;
-	
+	// average the input triggered since the last command over the sim step, so nothing between frames is lost
+	FVector MoveInputIntent = ConsumeMoveInputSamples(DeltaMs * 0.001f);
+
+	// AI controllers have no control rotation, so their world space steering goes through unchanged
+	if (!Controller->IsPlayerController())
+	{
+		const UCommonAIInputSubsystem* AIInput = GetWorld()->GetSubsystem<UCommonAIInputSubsystem>();
+		if (!AIInput || !AIInput->GetMoveInput(this, MoveInputIntent))
+		{
+			MoveInputIntent = FVector::ZeroVector;
+		}
+	}
 
 	// use only the control rotation yaw to avoid tapering our inputs if looking at the character from a too low or too high angle
 	FRotator ControlFacing = FRotator::ZeroRotator;
@@ -142,10 +193,73 @@ void ACommonMoverPawn::Move(const FInputActionValue& Value)
 	// set up the input vector. We flip the axis so they correspond with the expected Mover input
 	CachedMoveInputIntent.X = FMath::Clamp(MovementVector.Y, -1.0f, 1.0f);
 	CachedMoveInputIntent.Y = FMath::Clamp(MovementVector.X, -1.0f, 1.0f);
+
+	RecordMoveInputSample();
 }
 
 void ACommonMoverPawn::MoveCompleted(const FInputActionValue& Value)
 {
 	// zero out the cached input
 	CachedMoveInputIntent = FVector::ZeroVector;
+
+	RecordMoveInputSample();
+}
+
+void ACommonMoverPawn::RecordMoveInputSample()
+{
+	// the ring is full, so fold the oldest sample into the held input
+	if (NumMoveInputSamples == MaxMoveInputSamples)
+	{
+		HeldMoveInputIntent = MoveInputSamples[MoveInputSampleHead].MoveInputIntent;
+		MoveInputSampleHead = (MoveInputSampleHead + 1) % MaxMoveInputSamples;
+		--NumMoveInputSamples;
+	}
+
+	FCommonMoveInputSample& Sample = MoveInputSamples[(MoveInputSampleHead + NumMoveInputSamples) % MaxMoveInputSamples];
+	Sample.MoveInputIntent = CachedMoveInputIntent;
+	Sample.Time = GetWorld()->GetTimeSeconds();
+
+	++NumMoveInputSamples;
+}
+
+FVector ACommonMoverPawn::ConsumeMoveInputSamples(float WindowSeconds)
+{
+	if (NumMoveInputSamples == 0 || WindowSeconds <= UE_KINDA_SMALL_NUMBER)
+	{
+		NumMoveInputSamples = 0;
+		HeldMoveInputIntent = CachedMoveInputIntent;
+		return CachedMoveInputIntent;
+	}
+
+	// same clock as the sim time step, so dilation and pauses don't skew the window
+	const double Now = GetWorld()->GetTimeSeconds();
+	const double WindowStart = Now - WindowSeconds;
+
+	// each input is held from its own sample until the next one
+	FVector WeightedMoveInputIntent = FVector::ZeroVector;
+	FVector CurrentMoveInputIntent = HeldMoveInputIntent;
+	double SegmentStart = WindowStart;
+
+	for (int32 SampleIdx = 0; SampleIdx < NumMoveInputSamples; ++SampleIdx)
+	{
+		const FCommonMoveInputSample& Sample = MoveInputSamples[(MoveInputSampleHead + SampleIdx) % MaxMoveInputSamples];
+
+		// samples from before the window only tell us what was held when it started
+		if (Sample.Time > SegmentStart)
+		{
+			WeightedMoveInputIntent += CurrentMoveInputIntent * (Sample.Time - SegmentStart);
+			SegmentStart = Sample.Time;
+		}
+
+		CurrentMoveInputIntent = Sample.MoveInputIntent;
+	}
+
+	WeightedMoveInputIntent += CurrentMoveInputIntent * (Now - SegmentStart);
+
+	// start the next window from the latest input
+	MoveInputSampleHead = 0;
+	NumMoveInputSamples = 0;
+	HeldMoveInputIntent = CachedMoveInputIntent;
+
+	return WeightedMoveInputIntent / WindowSeconds;
 }
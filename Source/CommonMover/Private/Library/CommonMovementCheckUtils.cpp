@@ -15,7 +15,7 @@ bool UCommonMovementCheckUtils::IsFalling(const FSimulationTickParams& TickParam
 		Cast<UCommonMoverComponent>(TickParams.MovingComps.MoverComponent.Get());
 
 	return (TickParams.StartState.SyncState.MovementMode == DefaultModeNames::Falling) ||
-		(CommonMover->IsFalling());
+		(CommonMover && CommonMover->IsFalling());
 }
 
 bool UCommonMovementCheckUtils::IsWalking(const FSimulationTickParams& TickParams)
@@ -24,7 +24,7 @@ bool UCommonMovementCheckUtils::IsWalking(const FSimulationTickParams& TickParam
 		Cast<UCommonMoverComponent>(TickParams.MovingComps.MoverComponent.Get());
 
 	return (TickParams.StartState.SyncState.MovementMode == DefaultModeNames::Walking) ||
-		(CommonMover->IsOnGround());
+		(CommonMover && CommonMover->IsOnGround());
 }
 
 bool UCommonMovementCheckUtils::IsFlying(const FSimulationTickParams& TickParams)
@@ -33,7 +33,7 @@ bool UCommonMovementCheckUtils::IsFlying(const FSimulationTickParams& TickParams
 		Cast<UCommonMoverComponent>(TickParams.MovingComps.MoverComponent.Get());
 
 	return (TickParams.StartState.SyncState.MovementMode == DefaultModeNames::Flying) ||
-		(CommonMover->IsFlying());
+		(CommonMover && CommonMover->IsFlying());
 }
 
 bool UCommonMovementCheckUtils::IsSwimming(const FSimulationTickParams& TickParams)
@@ -42,5 +42,5 @@ bool UCommonMovementCheckUtils::IsSwimming(const FSimulationTickParams& TickPara
 		Cast<UCommonMoverComponent>(TickParams.MovingComps.MoverComponent.Get());
 
 	return (TickParams.StartState.SyncState.MovementMode == DefaultModeNames::Swimming) ||
-		(CommonMover->IsSwimming());
+		(CommonMover && CommonMover->IsSwimming());
 }
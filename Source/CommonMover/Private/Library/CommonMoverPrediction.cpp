@@ -0,0 +1,318 @@
+// Copyright © 2024 MajorT. All Rights Reserved.
+
+
+#include "Library/CommonMoverPrediction.h"
+
+#include "CommonAirModeBase.h"
+#include "CommonGroundModeBase.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(CommonMoverPrediction)
+
+namespace CommonMoverPrediction
+{
+	/** Gap kept between the shape and the floor, same as the floor adjustment of the ground modes */
+	static constexpr float FloorGap = 2.0f;
+
+	/** Maximum number of segments swept along an airborne trajectory per time step */
+	static constexpr int32 MaxTrajectorySegments = 8;
+}
+
+void FCommonMoverPrediction::Predict(
+	const FCommonMoverPredictionContext& Context,
+	const FCommonMoverPredictionParams& Params,
+	TArray<FCommonMoverPredictionSample>& OutSamples)
+{
+	check(IsInGameThread());
+
+	OutSamples.Reset();
+
+	if (const UWorld* World = Context.World.Get())
+	{
+		PredictInWorld(*World, Context, Params, OutSamples);
+	}
+}
+
+void FCommonMoverPrediction::PredictBatch(TArrayView<FCommonMoverPredictionRequest> Requests)
+{
+	check(IsInGameThread());
+
+	// Resolve the worlds up front, workers must not touch UObjects
+	TArray<const UWorld*, TInlineAllocator<16>> Worlds;
+	Worlds.SetNumUninitialized(Requests.Num());
+
+	for (int32 RequestIdx = 0; RequestIdx < Requests.Num(); ++RequestIdx)
+	{
+		Worlds[RequestIdx] = Requests[RequestIdx].Context.World.Get();
+		Requests[RequestIdx].Samples.Reset();
+	}
+
+	ParallelFor(Requests.Num(), [&Requests, &Worlds](int32 RequestIdx)
+	{
+		if (const UWorld* World = Worlds[RequestIdx])
+		{
+			FCommonMoverPredictionRequest& Request = Requests[RequestIdx];
+			PredictInWorld(*World, Request.Context, Request.Params, Request.Samples);
+		}
+	});
+}
+
+void FCommonMoverPrediction::PredictInWorld(
+	const UWorld& World,
+	const FCommonMoverPredictionContext& Context,
+	const FCommonMoverPredictionParams& Params,
+	TArray<FCommonMoverPredictionSample>& OutSamples)
+{
+	if (Params.TimeStep <= UE_KINDA_SMALL_NUMBER)
+	{
+		return;
+	}
+
+	const int32 NumSteps = FMath::Min(FMath::CeilToInt32(Params.Duration / Params.TimeStep), MaxSamples);
+	OutSamples.Reserve(NumSteps);
+
+	FScratchState State;
+	State.Location = Params.StartLocation;
+	State.Velocity = Params.StartVelocity;
+	State.bGrounded = Params.bStartGrounded;
+
+	if (State.bGrounded)
+	{
+		FindFloor(World, Context, State);
+	}
+
+	float Time = 0.0f;
+	for (int32 StepIdx = 0; StepIdx < NumSteps; ++StepIdx)
+	{
+		// The last step may be shorter
+		const float DeltaSeconds = FMath::Min(Params.TimeStep, Params.Duration - Time);
+		if (DeltaSeconds <= UE_KINDA_SMALL_NUMBER)
+		{
+			break;
+		}
+
+		ApplyInput(Context, Params.MoveInput, DeltaSeconds, State);
+
+		if (State.bGrounded)
+		{
+			StepGround(World, Context, DeltaSeconds, State);
+		}
+		else
+		{
+			StepAir(World, Context, DeltaSeconds, State);
+		}
+
+		Time += DeltaSeconds;
+
+		FCommonMoverPredictionSample& Sample = OutSamples.AddDefaulted_GetRef();
+		Sample.Location = State.Location;
+		Sample.Velocity = State.Velocity;
+		Sample.Time = Time;
+		Sample.bGrounded = State.bGrounded;
+	}
+}
+
+void FCommonMoverPrediction::ApplyInput(
+	const FCommonMoverPredictionContext& Context,
+	const FVector& MoveInput,
+	float DeltaSeconds,
+	FScratchState& State)
+{
+	const FVector PlanarVelocity = FVector::VectorPlaneProject(State.Velocity, Context.UpDirection);
+	const FVector VerticalVelocity = State.Velocity - PlanarVelocity;
+	const FVector TargetVelocity = FVector::VectorPlaneProject(MoveInput, Context.UpDirection).GetClampedToMaxSize(1.0f) * Context.MaxSpeed;
+
+	// Accelerate towards the input, or brake without one
+	float Acceleration = TargetVelocity.IsNearlyZero() ? Context.Deceleration : Context.Acceleration;
+	if (!State.bGrounded)
+	{
+		Acceleration *= Context.AirControlPercentage;
+	}
+
+	const FVector NewPlanarVelocity = PlanarVelocity + (TargetVelocity - PlanarVelocity).GetClampedToMaxSize(Acceleration * DeltaSeconds);
+
+	// Keep the vertical velocity while airborne, gravity is applied along the trajectory
+	State.Velocity = State.bGrounded ? NewPlanarVelocity : (NewPlanarVelocity + VerticalVelocity);
+}
+
+void FCommonMoverPrediction::StepGround(const UWorld& World, const FCommonMoverPredictionContext& Context, float DeltaSeconds, FScratchState& State)
+{
+	// Move along the floor we're standing on
+	FVector MoveDelta = FVector::VectorPlaneProject(State.Velocity * DeltaSeconds, State.FloorNormal);
+
+	FHitResult Hit;
+	if (SweepAndMove(World, Context, MoveDelta, State, Hit))
+	{
+		const FVector RemainingDelta = MoveDelta * (1.0f - Hit.Time);
+
+		if (UCommonGroundModeBase::IsRampHit(Hit, Context.UpDirection) && IsWalkable(Context, Hit))
+		{
+			// Ramp, continue along its surface
+			MoveDelta = FVector::VectorPlaneProject(RemainingDelta, Hit.Normal);
+			SweepAndMove(World, Context, MoveDelta, State, Hit);
+		}
+		else if (!TryStepUp(World, Context, RemainingDelta, State))
+		{
+			// Wall, slide along it
+			MoveDelta = UCommonGroundModeBase::ComputeWallSlideDelta(RemainingDelta, Hit.Normal, Context.UpDirection);
+			State.Velocity = UCommonGroundModeBase::ComputeWallSlideDelta(State.Velocity, Hit.Normal, Context.UpDirection);
+			SweepAndMove(World, Context, MoveDelta, State, Hit);
+		}
+	}
+
+	// Stay on the floor or start falling
+	FindFloor(World, Context, State);
+}
+
+void FCommonMoverPrediction::StepAir(const UWorld& World, const FCommonMoverPredictionContext& Context, float DeltaSeconds, FScratchState& State)
+{
+	const FVector StartLocation = State.Location;
+	const FVector StartVelocity = State.Velocity;
+	const FVector& Gravity = Context.GravityAcceleration;
+
+	const int32 NumSegments = UCommonAirModeBase::ComputeNumTrajectorySegments(
+		Gravity, DeltaSeconds, Context.TrajectoryTolerance, CommonMoverPrediction::MaxTrajectorySegments);
+
+	// Sweep each chord of the parabola
+	for (int32 SegmentIdx = 1; SegmentIdx <= NumSegments; ++SegmentIdx)
+	{
+		const float SegmentEndPct = static_cast<float>(SegmentIdx) / NumSegments;
+		const FVector SegmentEnd = UCommonAirModeBase::EvaluateTrajectory(StartLocation, StartVelocity, Gravity, DeltaSeconds * SegmentEndPct);
+
+		FHitResult Hit;
+		if (!SweepAndMove(World, Context, SegmentEnd - State.Location, State, Hit))
+		{
+			continue;
+		}
+
+		const float SegmentStartPct = static_cast<float>(SegmentIdx - 1) / NumSegments;
+		const float HitPct = SegmentStartPct + ((SegmentEndPct - SegmentStartPct) * Hit.Time);
+		State.Velocity = StartVelocity + (Gravity * (DeltaSeconds * HitPct));
+
+		// Landed?
+		if (UCommonAirModeBase::CanLandWithVelocity(State.Velocity, Context.UpDirection) && IsWalkable(Context, Hit))
+		{
+			State.Velocity = FVector::VectorPlaneProject(State.Velocity, Context.UpDirection);
+			State.bGrounded = true;
+			FindFloor(World, Context, State);
+
+			if (State.bGrounded)
+			{
+				return;
+			}
+		}
+
+		// Slide along the surface towards where the trajectory would have taken us
+		const FVector TrajectoryEnd = UCommonAirModeBase::EvaluateTrajectory(StartLocation, StartVelocity, Gravity, DeltaSeconds);
+		const FVector SlideDelta = FVector::VectorPlaneProject(TrajectoryEnd - State.Location, Hit.Normal);
+		const FVector HitNormal = Hit.Normal;
+		SweepAndMove(World, Context, SlideDelta, State, Hit);
+
+		State.Velocity = UCommonAirModeBase::ComputeSurfaceSlideVelocity(State.Velocity, HitNormal) + (Gravity * (DeltaSeconds * (1.0f - HitPct)));
+		return;
+	}
+
+	State.Velocity = StartVelocity + (Gravity * DeltaSeconds);
+}
+
+bool FCommonMoverPrediction::TryStepUp(const UWorld& World, const FCommonMoverPredictionContext& Context, const FVector& Delta, FScratchState& State)
+{
+	FScratchState StepState = State;
+	FHitResult Hit;
+
+	// Up, forward, then down onto the step
+	const FVector StepUpDelta = Context.UpDirection * Context.MaxStepHeight;
+	SweepAndMove(World, Context, StepUpDelta, StepState, Hit);
+
+	const FVector PlanarDelta = FVector::VectorPlaneProject(Delta, Context.UpDirection);
+	if (SweepAndMove(World, Context, PlanarDelta, StepState, Hit) && Hit.Time < UE_KINDA_SMALL_NUMBER)
+	{
+		// Still blocked, this is a wall
+		return false;
+	}
+
+	const FVector StepDownDelta = -Context.UpDirection * (Context.MaxStepHeight + Context.FloorSweepDistance);
+	if (!SweepAndMove(World, Context, StepDownDelta, StepState, Hit) || !IsWalkable(Context, Hit))
+	{
+		return false;
+	}
+
+	State.Location = StepState.Location;
+	return true;
+}
+
+void FCommonMoverPrediction::FindFloor(const UWorld& World, const FCommonMoverPredictionContext& Context, FScratchState& State)
+{
+	const FVector FloorSweepEnd = State.Location - (Context.UpDirection * Context.FloorSweepDistance);
+
+	FHitResult Hit;
+	const bool bFoundFloor = World.SweepSingleByChannel(
+		Hit,
+		State.Location,
+		FloorSweepEnd,
+		Context.CollisionRotation,
+		Context.CollisionChannel,
+		Context.CollisionShape,
+		Context.QueryParams,
+		Context.ResponseParams);
+
+	if (bFoundFloor && !Hit.bStartPenetrating && IsWalkable(Context, Hit))
+	{
+		// Snap onto the floor
+		State.Location = Hit.Location + (Context.UpDirection * CommonMoverPrediction::FloorGap);
+		State.FloorNormal = Hit.ImpactNormal;
+		State.bGrounded = true;
+		return;
+	}
+
+	// No floor, start falling
+	State.FloorNormal = Context.UpDirection;
+	State.bGrounded = false;
+}
+
+bool FCommonMoverPrediction::SweepAndMove(
+	const UWorld& World,
+	const FCommonMoverPredictionContext& Context,
+	const FVector& Delta,
+	FScratchState& State,
+	FHitResult& OutHit)
+{
+	if (Delta.IsNearlyZero())
+	{
+		OutHit.Reset(1.0f, false);
+		return false;
+	}
+
+	const FVector End = State.Location + Delta;
+
+	if (!World.SweepSingleByChannel(
+		OutHit,
+		State.Location,
+		End,
+		Context.CollisionRotation,
+		Context.CollisionChannel,
+		Context.CollisionShape,
+		Context.QueryParams,
+		Context.ResponseParams))
+	{
+		State.Location = End;
+		return false;
+	}
+
+	if (OutHit.bStartPenetrating)
+	{
+		// Push out of whatever we started in and give up on this move
+		State.Location += OutHit.Normal * (OutHit.PenetrationDepth + UE_KINDA_SMALL_NUMBER);
+		OutHit.Time = 0.0f;
+		return true;
+	}
+
+	State.Location = OutHit.Location;
+	return true;
+}
+
+bool FCommonMoverPrediction::IsWalkable(const FCommonMoverPredictionContext& Context, const FHitResult& Hit)
+{
+	return Hit.IsValidBlockingHit() && (FVector::DotProduct(Hit.ImpactNormal, Context.UpDirection) >= Context.MaxWalkSlopeCosine);
+}
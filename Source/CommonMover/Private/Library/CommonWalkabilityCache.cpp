@@ -0,0 +1,44 @@
+// Copyright © 2024 MajorT. All Rights Reserved.
+
+
+#include "Library/CommonWalkabilityCache.h"
+
+#include "GameFramework/Pawn.h"
+
+bool FCommonWalkabilityCache::CanCharacterStepUp(const FHitResult& Hit)
+{
+	const UPrimitiveComponent* HitComponent = Hit.GetComponent();
+	if (!HitComponent)
+	{
+		return false;
+	}
+
+	// Anything but an owner decision on static geometry is just a flag check
+	if (HitComponent->CanCharacterStepUpOn != ECB_Owner || HitComponent->Mobility != EComponentMobility::Static)
+	{
+		return HitComponent->CanCharacterStepUp(Cast<APawn>(Hit.GetActor()));
+	}
+
+	if (const bool* bCanStepUp = Components.Find(HitComponent))
+	{
+		return *bCanStepUp;
+	}
+
+	// Flush everything if we've been hitting too many different components
+	if (Components.Num() >= MaxCachedComponents)
+	{
+		Components.Reset();
+	}
+
+	return Components.Add(HitComponent, HitComponent->CanCharacterStepUp(nullptr));
+}
+
+void FCommonWalkabilityCache::InvalidateComponent(const UPrimitiveComponent* Component)
+{
+	Components.Remove(Component);
+}
+
+void FCommonWalkabilityCache::Reset()
+{
+	Components.Reset();
+}
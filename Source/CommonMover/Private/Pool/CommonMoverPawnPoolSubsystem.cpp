@@ -0,0 +1,159 @@
+// Copyright © 2024 MajorT. All Rights Reserved.
+
+
+#include "Pool/CommonMoverPawnPoolSubsystem.h"
+
+#include "CommonMoverComponent.h"
+#include "Examples/CommonMoverPawn.h"
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(CommonMoverPawnPoolSubsystem)
+
+void UCommonMoverPawnPoolSubsystem::Deinitialize()
+{
+	Pools.Reset();
+
+	Super::Deinitialize();
+}
+
+ACommonMoverPawn* UCommonMoverPawnPoolSubsystem::AcquirePawn(TSubclassOf<ACommonMoverPawn> PawnClass, const FTransform& Transform, const FVector& Velocity)
+{
+	if (!PawnClass)
+	{
+		UE_LOG(LogMover, Warning, TEXT("[%hs]: No pawn class given"), __FUNCTION__);
+		return nullptr;
+	}
+
+	// Reuse the most recently released pawn, skipping any that got destroyed while pooled
+	if (FCommonMoverPawnPool* Pool = Pools.Find(PawnClass))
+	{
+		while (!Pool->Pawns.IsEmpty())
+		{
+			ACommonMoverPawn* Pawn = Pool->Pawns.Pop(EAllowShrinking::No);
+			if (IsValid(Pawn))
+			{
+				ActivatePawn(Pawn, Transform, Velocity);
+				return Pawn;
+			}
+		}
+	}
+
+	ACommonMoverPawn* Pawn = SpawnPawn(PawnClass, Transform);
+
+	// Fresh pawns start at rest, hand them the velocity
+	UCommonMoverComponent* MoverComponent = Pawn ? Pawn->GetMoverComponent() : nullptr;
+	if (MoverComponent && !Velocity.IsZero())
+	{
+		MoverComponent->ResetMoverState(Transform.GetLocation(), Transform.Rotator(), Velocity);
+	}
+
+	return Pawn;
+}
+
+void UCommonMoverPawnPoolSubsystem::ReleasePawn(ACommonMoverPawn* Pawn)
+{
+	if (!IsValid(Pawn))
+	{
+		return;
+	}
+
+	FCommonMoverPawnPool& Pool = Pools.FindOrAdd(Pawn->GetClass());
+	if (Pool.Pawns.Num() >= MaxPooledPawnsPerClass)
+	{
+		Pawn->Destroy();
+		return;
+	}
+
+	if (!ensureMsgf(!Pool.Pawns.Contains(Pawn), TEXT("Pawn %s was released twice"), *Pawn->GetName()))
+	{
+		return;
+	}
+
+	DeactivatePawn(Pawn);
+	Pool.Pawns.Add(Pawn);
+}
+
+void UCommonMoverPawnPoolSubsystem::PrewarmPool(TSubclassOf<ACommonMoverPawn> PawnClass, int32 Count)
+{
+	if (!PawnClass)
+	{
+		return;
+	}
+
+	const FTransform ParkingTransform(ParkingLocation);
+	const int32 TargetCount = FMath::Min(Count, MaxPooledPawnsPerClass);
+
+	FCommonMoverPawnPool& Pool = Pools.FindOrAdd(PawnClass);
+	while (Pool.Pawns.Num() < TargetCount)
+	{
+		ACommonMoverPawn* Pawn = SpawnPawn(PawnClass, ParkingTransform);
+		if (!Pawn)
+		{
+			break;
+		}
+
+		DeactivatePawn(Pawn);
+		Pool.Pawns.Add(Pawn);
+	}
+}
+
+int32 UCommonMoverPawnPoolSubsystem::GetNumPooledPawns(TSubclassOf<ACommonMoverPawn> PawnClass) const
+{
+	const FCommonMoverPawnPool* Pool = Pools.Find(PawnClass);
+	return Pool ? Pool->Pawns.Num() : 0;
+}
+
+ACommonMoverPawn* UCommonMoverPawnPoolSubsystem::SpawnPawn(TSubclassOf<ACommonMoverPawn> PawnClass, const FTransform& Transform) const
+{
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	ACommonMoverPawn* Pawn = GetWorld()->SpawnActor<ACommonMoverPawn>(PawnClass, Transform, SpawnParams);
+	if (!IsValid(Pawn))
+	{
+		UE_LOG(LogMover, Warning, TEXT("[%hs]: Couldn't spawn a pawn of class %s"), __FUNCTION__, *GetNameSafe(PawnClass));
+		return nullptr;
+	}
+
+	return Pawn;
+}
+
+void UCommonMoverPawnPoolSubsystem::DeactivatePawn(ACommonMoverPawn* Pawn) const
+{
+	if (AController* Controller = Pawn->GetController())
+	{
+		Controller->UnPossess();
+	}
+
+	Pawn->SetActorHiddenInGame(true);
+	Pawn->SetActorEnableCollision(false);
+	Pawn->SetActorTickEnabled(false);
+
+	// Park the pawn and keep it out of proximity queries while it's pooled
+	if (UCommonMoverComponent* MoverComponent = Pawn->GetMoverComponent())
+	{
+		MoverComponent->UnregisterFromSpatialHash();
+		MoverComponent->ResetMoverState(ParkingLocation, FRotator::ZeroRotator);
+		MoverComponent->SetMovementDisabled(true);
+		MoverComponent->SetSimulationTickEnabled(false);
+	}
+}
+
+void UCommonMoverPawnPoolSubsystem::ActivatePawn(ACommonMoverPawn* Pawn, const FTransform& Transform, const FVector& Velocity) const
+{
+	if (UCommonMoverComponent* MoverComponent = Pawn->GetMoverComponent())
+	{
+		MoverComponent->SetSimulationTickEnabled(true);
+		MoverComponent->ResetMoverState(Transform.GetLocation(), Transform.Rotator(), Velocity);
+		MoverComponent->RegisterInSpatialHash();
+	}
+	else
+	{
+		Pawn->SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+	}
+
+	Pawn->SetActorHiddenInGame(false);
+	Pawn->SetActorEnableCollision(true);
+	Pawn->SetActorTickEnabled(true);
+}
@@ -0,0 +1,242 @@
+// Copyright © 2024 MajorT. All Rights Reserved.
+
+
+#include "Spatial/CommonMoverSpatialHashSubsystem.h"
+
+#include "CommonMoverComponent.h"
+#include "Algo/BinarySearch.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(CommonMoverSpatialHashSubsystem)
+
+void UCommonMoverSpatialHashSubsystem::Deinitialize()
+{
+	Entries.Empty();
+	EntryIndices.Empty();
+	Cells.Empty();
+
+	Super::Deinitialize();
+}
+
+void UCommonMoverSpatialHashSubsystem::RegisterMover(UCommonMoverComponent* Mover, const FVector& Location, float Radius, float HalfHeight)
+{
+	if (!Mover)
+	{
+		return;
+	}
+
+	if (const int32* ExistingIdx = EntryIndices.Find(Mover))
+	{
+		FCommonMoverSpatialEntry& Entry = Entries[*ExistingIdx];
+		Entry.Radius = Radius;
+		Entry.HalfHeight = HalfHeight;
+		UpdateMover(Mover, Location);
+		return;
+	}
+
+	const int32 EntryIdx = Entries.AddDefaulted();
+	FCommonMoverSpatialEntry& Entry = Entries[EntryIdx];
+	Entry.Mover = Mover;
+	Entry.MoverKey = Mover;
+	Entry.Location = Location;
+	Entry.Radius = Radius;
+	Entry.HalfHeight = HalfHeight;
+	Entry.Cell = GetCell(Location);
+
+	EntryIndices.Add(Mover, EntryIdx);
+	AddToCell(Entry.Cell, EntryIdx);
+}
+
+void UCommonMoverSpatialHashSubsystem::UnregisterMover(const UCommonMoverComponent* Mover)
+{
+	int32 EntryIdx = INDEX_NONE;
+	if (!EntryIndices.RemoveAndCopyValue(Mover, EntryIdx))
+	{
+		return;
+	}
+
+	RemoveFromCell(Entries[EntryIdx].Cell, EntryIdx);
+
+	// Move the last entry into the hole
+	const int32 LastIdx = Entries.Num() - 1;
+	if (EntryIdx != LastIdx)
+	{
+		const FCommonMoverSpatialEntry& LastEntry = Entries[LastIdx];
+		RemoveFromCell(LastEntry.Cell, LastIdx);
+		AddToCell(LastEntry.Cell, EntryIdx);
+
+		if (int32* LastEntryIdx = EntryIndices.Find(LastEntry.MoverKey))
+		{
+			*LastEntryIdx = EntryIdx;
+		}
+	}
+
+	Entries.RemoveAtSwap(EntryIdx, 1, EAllowShrinking::No);
+}
+
+void UCommonMoverSpatialHashSubsystem::UpdateMover(const UCommonMoverComponent* Mover, const FVector& Location)
+{
+	const int32* EntryIdx = EntryIndices.Find(Mover);
+	if (!EntryIdx)
+	{
+		return;
+	}
+
+	FCommonMoverSpatialEntry& Entry = Entries[*EntryIdx];
+	Entry.Location = Location;
+
+	// Only touch the grid when we changed cells
+	const FIntPoint NewCell = GetCell(Location);
+	if (NewCell != Entry.Cell)
+	{
+		RemoveFromCell(Entry.Cell, *EntryIdx);
+		AddToCell(NewCell, *EntryIdx);
+		Entry.Cell = NewCell;
+	}
+}
+
+void UCommonMoverSpatialHashSubsystem::ForEachMoverInRadius(
+	const FVector& Center,
+	float Radius,
+	TFunctionRef<void(const FCommonMoverSpatialEntry&)> Visitor) const
+{
+	const FIntPoint MinCell = GetCell(Center - FVector(Radius));
+	const FIntPoint MaxCell = GetCell(Center + FVector(Radius));
+	const float RadiusSq = FMath::Square(Radius);
+
+	// Huge radii cover more cells than we have, so walk the occupied cells instead
+	const int64 NumCellsInRange = static_cast<int64>(MaxCell.X - MinCell.X + 1) * static_cast<int64>(MaxCell.Y - MinCell.Y + 1);
+	if (NumCellsInRange > Cells.Num())
+	{
+		for (const auto& Cell : Cells)
+		{
+			if (Cell.Key.X < MinCell.X || Cell.Key.X > MaxCell.X || Cell.Key.Y < MinCell.Y || Cell.Key.Y > MaxCell.Y)
+			{
+				continue;
+			}
+
+			for (const int32 EntryIdx : Cell.Value)
+			{
+				const FCommonMoverSpatialEntry& Entry = Entries[EntryIdx];
+				if (FVector::DistSquared(Center, Entry.Location) <= RadiusSq)
+				{
+					Visitor(Entry);
+				}
+			}
+		}
+
+		return;
+	}
+
+	for (int32 CellX = MinCell.X; CellX <= MaxCell.X; ++CellX)
+	{
+		for (int32 CellY = MinCell.Y; CellY <= MaxCell.Y; ++CellY)
+		{
+			const auto* CellEntries = Cells.Find(FIntPoint(CellX, CellY));
+			if (!CellEntries)
+			{
+				continue;
+			}
+
+			for (const int32 EntryIdx : *CellEntries)
+			{
+				const FCommonMoverSpatialEntry& Entry = Entries[EntryIdx];
+				if (FVector::DistSquared(Center, Entry.Location) <= RadiusSq)
+				{
+					Visitor(Entry);
+				}
+			}
+		}
+	}
+}
+
+int32 UCommonMoverSpatialHashSubsystem::FindMoversInRadius(
+	const FVector& Center,
+	float Radius,
+	TArray<UCommonMoverComponent*>& OutMovers,
+	const UCommonMoverComponent* IgnoredMover) const
+{
+	OutMovers.Reset();
+
+	ForEachMoverInRadius(Center, Radius, [&OutMovers, IgnoredMover](const FCommonMoverSpatialEntry& Entry)
+	{
+		UCommonMoverComponent* Mover = Entry.Mover.Get();
+		if (Mover && Mover != IgnoredMover)
+		{
+			OutMovers.Add(Mover);
+		}
+	});
+
+	return OutMovers.Num();
+}
+
+int32 UCommonMoverSpatialHashSubsystem::FindNearestMovers(
+	const FVector& Center,
+	int32 MaxCount,
+	float MaxRadius,
+	TArray<UCommonMoverComponent*>& OutMovers,
+	const UCommonMoverComponent* IgnoredMover) const
+{
+	OutMovers.Reset();
+
+	if (MaxCount <= 0)
+	{
+		return 0;
+	}
+
+	// Keep the closest candidates sorted, dropping the furthest once we have enough
+	TArray<TPair<float, UCommonMoverComponent*>, TInlineAllocator<16>> Candidates;
+	ForEachMoverInRadius(Center, MaxRadius, [&](const FCommonMoverSpatialEntry& Entry)
+	{
+		UCommonMoverComponent* Mover = Entry.Mover.Get();
+		if (!Mover || Mover == IgnoredMover)
+		{
+			return;
+		}
+
+		const float DistSq = FVector::DistSquared(Center, Entry.Location);
+		if (Candidates.Num() == MaxCount && DistSq >= Candidates.Last().Key)
+		{
+			return;
+		}
+
+		const int32 InsertIdx = Algo::UpperBoundBy(Candidates, DistSq, [](const TPair<float, UCommonMoverComponent*>& Candidate) { return Candidate.Key; });
+		Candidates.Insert(MakeTuple(DistSq, Mover), InsertIdx);
+
+		if (Candidates.Num() > MaxCount)
+		{
+			Candidates.Pop(EAllowShrinking::No);
+		}
+	});
+
+	OutMovers.Reserve(Candidates.Num());
+	for (const TPair<float, UCommonMoverComponent*>& Candidate : Candidates)
+	{
+		OutMovers.Add(Candidate.Value);
+	}
+
+	return OutMovers.Num();
+}
+
+FIntPoint UCommonMoverSpatialHashSubsystem::GetCell(const FVector& Location) const
+{
+	return FIntPoint(
+		FMath::FloorToInt32(Location.X / CellSize),
+		FMath::FloorToInt32(Location.Y / CellSize));
+}
+
+void UCommonMoverSpatialHashSubsystem::AddToCell(const FIntPoint& Cell, int32 EntryIdx)
+{
+	Cells.FindOrAdd(Cell).Add(EntryIdx);
+}
+
+void UCommonMoverSpatialHashSubsystem::RemoveFromCell(const FIntPoint& Cell, int32 EntryIdx)
+{
+	if (auto* CellEntries = Cells.Find(Cell))
+	{
+		CellEntries->RemoveSingleSwap(EntryIdx, EAllowShrinking::No);
+		if (CellEntries->IsEmpty())
+		{
+			Cells.Remove(Cell);
+		}
+	}
+}
@@ -0,0 +1,108 @@
+// Copyright © 2024 MajorT. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+
+#include "CommonAIInputSubsystem.generated.h"
+
+class ACommonMoverPawn;
+
+/** An AI controlled mover following a path corridor */
+struct FCommonAIInputAgent
+{
+	/** The steered pawn */
+	TWeakObjectPtr<ACommonMoverPawn> Pawn;
+
+	/** Key of the pawn, still valid after the pawn got destroyed */
+	TObjectKey<ACommonMoverPawn> PawnKey;
+
+	/** Path points we're following, from the start to the goal */
+	TArray<FVector> Corridor;
+
+	/** Index of the corridor point we're currently heading to */
+	int32 CorridorIndex = 0;
+
+	/** Distance to the goal at which we stop moving */
+	float AcceptanceRadius = 50.0f;
+
+	/** Location of the pawn, gathered on the game thread before steering */
+	FVector Location = FVector::ZeroVector;
+
+	/** Steering result, in world space */
+	FVector MoveInput = FVector::ZeroVector;
+
+	/** Returns true if we still have somewhere to go */
+	bool IsMoving() const { return Corridor.IsValidIndex(CorridorIndex); }
+};
+
+/** Produces move input for every AI controlled CommonMover pawn in a single batched pass per frame.
+ * Pawns possessed by a non-player controller register themselves and read their steering from here in ProduceInput,
+ * so following a path costs a lookup per pawn on the game thread instead of a full steering update. */
+UCLASS()
+class COMMONMOVER_API UCommonAIInputSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	//~ Begin UWorldSubsystem Interface
+	virtual void Deinitialize() override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	//~ End UWorldSubsystem Interface
+
+	//~ Begin FTickableGameObject Interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	//~ End FTickableGameObject Interface
+
+	/** Starts steering the pawn. It stands still until it gets a path. */
+	void RegisterAgent(ACommonMoverPawn* Pawn);
+
+	/** Stops steering the pawn */
+	void UnregisterAgent(const ACommonMoverPawn* Pawn);
+
+	/** Finds a path on the navmesh to the goal and starts following it. Returns false if no path was found. */
+	UFUNCTION(BlueprintCallable, Category="Mover|AI")
+	bool MoveToLocation(ACommonMoverPawn* Pawn, const FVector& Goal, float AcceptanceRadius = 50.0f);
+
+	/** Starts following the given path corridor. Returns false if the pawn isn't registered. */
+	UFUNCTION(BlueprintCallable, Category="Mover|AI")
+	bool FollowCorridor(ACommonMoverPawn* Pawn, const TArray<FVector>& Corridor, float AcceptanceRadius = 50.0f);
+
+	/** Stops the pawn where it is */
+	UFUNCTION(BlueprintCallable, Category="Mover|AI")
+	void StopMovement(ACommonMoverPawn* Pawn);
+
+	/** Returns true if the pawn is still following a path */
+	UFUNCTION(BlueprintPure, Category="Mover|AI")
+	bool IsFollowingPath(const ACommonMoverPawn* Pawn) const;
+
+	/** Returns the move input computed for the pawn this frame. Returns false if the pawn isn't registered. */
+	bool GetMoveInput(const ACommonMoverPawn* Pawn, FVector& OutMoveInput) const;
+
+protected:
+	/** Computes the steering of a single agent. Runs on worker threads, so it may only touch the agent. */
+	void SteerAgent(FCommonAIInputAgent& Agent) const;
+
+public:
+	/** Distance ahead along the corridor we steer towards. Larger values cut corners more. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Mover|AI", meta=(ClampMin=0, ForceUnits="cm"))
+	float LookAheadDistance = 150.0f;
+
+	/** Distance to the goal at which we start slowing down */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Mover|AI", meta=(ClampMin=0, ForceUnits="cm"))
+	float ArrivalSlowdownDistance = 200.0f;
+
+	/** Below this many agents, steering runs on the game thread instead of being spread over workers */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Mover|AI", meta=(ClampMin=1))
+	int32 MinAgentsPerTask = 32;
+
+protected:
+	/** Densely packed agents */
+	TArray<FCommonAIInputAgent> Agents;
+
+	/** Agent index of every registered pawn */
+	TMap<TObjectKey<ACommonMoverPawn>, int32> AgentIndices;
+};
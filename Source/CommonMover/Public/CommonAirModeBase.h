@@ -0,0 +1,69 @@
+// Copyright © 2024 MajorT. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CommonMovementMode.h"
+#include "CommonAirModeBase.generated.h"
+
+/** Base class for all airborne movement modes.
+ * Integrates ballistic motion analytically and sweeps along the resulting parabola, using as few sweeps as its curvature allows.
+ */
+UCLASS(Abstract)
+class COMMONMOVER_API UCommonAirModeBase : public UCommonMovementMode
+{
+	GENERATED_BODY()
+
+public:
+	UCommonAirModeBase(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+
+	/** Returns the position along a ballistic trajectory after the given time */
+	static FVector EvaluateTrajectory(const FVector& StartLocation, const FVector& StartVelocity, const FVector& Gravity, float Time);
+
+	/** Returns the number of straight segments needed to follow a ballistic trajectory, so no segment strays further than the tolerance from the curve */
+	static int32 ComputeNumTrajectorySegments(const FVector& Gravity, float Duration, float Tolerance, int32 MaxSegments);
+
+	/** Returns true if the velocity allows landing on what we hit. The surface still has to be walkable. */
+	static bool CanLandWithVelocity(const FVector& Velocity, const FVector& UpDirection);
+
+	/** Returns the velocity left after hitting a surface, without the part going into it */
+	static FVector ComputeSurfaceSlideVelocity(const FVector& Velocity, const FVector& HitNormal);
+
+protected:
+	//~ Begin UCommonMovementMode
+	virtual void PreMove(FMoverTickEndData& OutputState) override;
+	virtual void ApplyMovement(FMoverTickEndData& OutputState) override;
+	//~ End UCommonMovementMode
+
+	/** Sweeps the updated component along the ballistic trajectory. Returns true if we hit something on the way. */
+	virtual bool ApplyTrajectoryMove(FCommonMoveData& AirData, const FVector& StartVelocity, const FVector& Gravity);
+
+	/** Probes for a walkable floor after hitting a surface and transitions to the landing mode. Returns true if we landed. */
+	virtual bool HandleLanding(FMoverTickEndData& OutputState, FCommonMoveData& AirData, const FVector& LandingVelocity);
+
+	/** Slides along a surface we hit while airborne, for the rest of the trajectory */
+	virtual bool ApplySlideAlongSurface(FCommonMoveData& AirData, const FVector& TrajectoryEnd, FVector& InOutVelocity);
+
+	/** Captures the final movement state for the simulation frame and updates the output default sync state */
+	void CaptureFinalState(const FVector& FinalVelocity) const;
+
+	/** Returns the name of the movement mode that will handle landing */
+	virtual const FName& GetLandingModeName() const;
+
+protected:
+	/** Maximum distance a trajectory segment can stray from the actual parabola */
+	UPROPERTY(Category=Mover, EditAnywhere, BlueprintReadWrite, meta=(ClampMin=0.01, ForceUnits="cm"))
+	float TrajectoryTolerance = 2.0f;
+
+	/** Maximum number of trajectory segments swept per simulation frame */
+	UPROPERTY(Category=Mover, EditAnywhere, BlueprintReadWrite, meta=(ClampMin=1))
+	int32 MaxTrajectorySegments = 4;
+
+	/** Maximum speed along the gravity direction */
+	UPROPERTY(Category=Mover, EditAnywhere, BlueprintReadWrite, meta=(ClampMin=0, ForceUnits="cm/s"))
+	float TerminalVerticalSpeed = 4000.0f;
+
+	/** Mode to switch to after landing on a walkable floor */
+	UPROPERTY(Category=Mover, EditAnywhere, BlueprintReadWrite)
+	FName LandingModeName;
+};
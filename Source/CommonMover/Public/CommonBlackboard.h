@@ -7,4 +7,7 @@ namespace CommonBlackboard
 {
 	const FName LastFallTime = TEXT("LastFallTime");
 	const FName LastJumpTime = TEXT("LastJumpTime");
+	const FName FloorSimplicity = TEXT("FloorSimplicity");
+	const FName LastStaircase = TEXT("LastStaircase");
+	const FName PendingMove = TEXT("PendingMove");
 }
\ No newline at end of file
@@ -0,0 +1,35 @@
+// Copyright © 2024 MajorT. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MoverDataModelTypes.h"
+
+#include "CommonCharacterInputs.generated.h"
+
+/** Character inputs with a compact network representation.
+ * Intent vectors and the control rotation are quantized, flags are bit-packed, and the movement base is only sent while it's in use. */
+USTRUCT(BlueprintType)
+struct COMMONMOVER_API FCommonCharacterInputs : public FCharacterDefaultInputs
+{
+	GENERATED_BODY()
+
+public:
+	virtual ~FCommonCharacterInputs() override = default;
+
+	//~ Begin FMoverDataStructBase Interface
+	virtual FMoverDataStructBase* Clone() const override;
+	virtual bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess) override;
+	virtual UScriptStruct* GetScriptStruct() const override;
+	//~ End FMoverDataStructBase Interface
+};
+
+template<>
+struct TStructOpsTypeTraits< FCommonCharacterInputs > : public TStructOpsTypeTraitsBase2< FCommonCharacterInputs >
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithCopy = true
+	};
+};
@@ -8,6 +8,56 @@
 #include "MoveLibrary/FloorQueryUtils.h"
 #include "CommonGroundModeBase.generated.h"
 
+class FCommonWalkabilityCache;
+
+/** Tracks how stable the floor has been over the last frames, so we know when a line trace is enough to find it. */
+struct FCommonFloorSimplicity
+{
+	/** Component we've been standing on */
+	TWeakObjectPtr<const UPrimitiveComponent> Component;
+
+	/** Floor normal when we started tracking the component */
+	FVector Normal = FVector::UpVector;
+
+	/** Number of consecutive frames the floor has been simple */
+	int32 StableFrames = 0;
+};
+
+/** Parameters of the staircase we're currently climbing, learned from consecutive step ups. */
+struct FCommonStaircaseInfo
+{
+	/** Location we were at after the last step */
+	FVector LastStepLocation = FVector::ZeroVector;
+
+	/** Direction the staircase climbs in, on the plane perpendicular to the mover's up direction */
+	FVector Direction = FVector::ZeroVector;
+
+	/** Height of a single step */
+	float Rise = 0.0f;
+
+	/** Horizontal depth of a single step */
+	float Run = 0.0f;
+
+	/** Number of consecutive steps with a matching rise and run */
+	int32 ConsecutiveSteps = 0;
+};
+
+/** Movement too small to be worth sweeping, accumulated across frames until it is. */
+struct FCommonPendingMove
+{
+	/** Accumulated move delta */
+	FVector Delta = FVector::ZeroVector;
+
+	/** Move input when we started accumulating */
+	FVector MoveInput = FVector::ZeroVector;
+
+	/** Simulation time covered by the accumulated delta */
+	float AccumulatedSeconds = 0.0f;
+
+	/** Number of frames covered by the accumulated delta */
+	int32 NumFrames = 0;
+};
+
 /** Base class for all ground movement modes.
  * Establishes a common simulation structure to handle slopes, stairs, and other obstacles.
  */
@@ -19,34 +69,72 @@ class COMMONMOVER_API UCommonGroundModeBase : public UCommonMovementMode
 public:
 	UCommonGroundModeBase(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
 
+	/** Returns true if the hit could be a ramp we can move up onto. The surface still has to be walkable. */
+	static bool IsRampHit(const FHitResult& Hit, const FVector& UpDirection);
+
+	/** Returns the part of the delta that slides along a wall while staying on the ground plane */
+	static FVector ComputeWallSlideDelta(const FVector& Delta, const FVector& WallNormal, const FVector& UpDirection);
+
+	virtual void OnRegistered(const FName ModeName) override;
+	virtual void OnUnregistered() override;
+
 protected:
 	//~ Begin UCommonMovementMOde
 	virtual void ApplyMovement(FMoverTickEndData& OutputState) override;
+	virtual void ApplyExtrapolationOnly(FMoverTickEndData& OutputState) override;
+	virtual bool RefreshSettingsSnapshot() override;
 	//~ End UCommonMovementMode
 
+	/** Runs a single movement substep through every moving stage, from the first move to the floor adjustment.
+	 * Returns true if we started falling and the output state has already been captured. */
+	virtual bool ApplyMoveSubstep(FMoverTickEndData& OutputState, FCommonMoveData& WalkData, FOptionalFloorCheckResult& StepUpFloorResult, float SubstepStartPct, float SubstepPct, bool& bOutIsStuck);
+
+	/** Pushes us out of any overlapping movers found in the spatial hash, by resolving the overlap between both capsules analytically.
+	 * The push is added to the move delta, so it goes through the regular moving stages, but it's not part of the resulting velocity.
+	 * Returns true if we got pushed. */
+	virtual bool ApplyPawnSeparation(FCommonMoveData& WalkData);
+
+	/** Defers moves shorter than MinMovementThreshold and adds them up until they're worth sweeping, for at most MaxCoalescedFrames.
+	 * Anything deferred is applied as soon as we stop moving or the input changes.
+	 * Returns true if this frame's move got deferred. Otherwise the move data holds the move to apply, including anything deferred so far. */
+	virtual bool CoalesceMicroMovement(FCommonMoveData& WalkData);
+
+	/** Returns the number of substeps needed to move the given delta without skipping over obstacles */
+	int32 ComputeNumSubsteps(const FVector& MoveDelta) const;
+
 	/** Validates the floor prior to any movement */
-	virtual void ValidateFloor(float FloorSweepDistance, float MaxWalkableSlopeCosine);
+	virtual void ValidateFloor();
 
 	/** Attempts to move the updated comp along any dynamically moving floor it is standing on */
 	virtual bool ApplyDynamicFloorMovement(FMoverTickEndData& OutputState, FMovementRecord& MoveRecord);
 
+	/** Moves the updated comp kinematically along with its base. Returns false if the base's rotation moved us too far to skip the sweep. */
+	virtual bool TryMoveKinematicallyWithBase(const FVector& NewBaseLocation, const FQuat& NewBaseRotation);
+
 	/** Applies the first free movement. Returns true if the updated component was successfully moved. */
 	virtual bool ApplyFirstMove(FCommonMoveData& WalkData);
 
-	/** Attempts to de-penetrate the updated component prior to its first move */
+	/** Attempts to de-penetrate the updated component after its first move and retries the remaining move. Returns true if we're still stuck. */
 	virtual bool ApplyDepenetrationOnFirstMove(FCommonMoveData& WalkData);
 
 	/** Calculates ramp deflection and moves the updated component up a ramp */
-	virtual bool ApplyRampMove(FCommonMoveData& WalkData, float MaxWalkableSlopeCosine);
+	virtual bool ApplyRampMove(FCommonMoveData& WalkData);
 
 	/** Attempts to move the updated component over a climbable obstacle */
-	virtual bool ApplyStepUpMove(FCommonMoveData& WalkData, FOptionalFloorCheckResult& StepUpFloorResult, float MaxWalkableSlopeCosine, float MaxStepHeight, float FloorSweepDistance);
+	virtual bool ApplyStepUpMove(FCommonMoveData& WalkData, FOptionalFloorCheckResult& StepUpFloorResult);
+
+	/** Attempts to climb the next step of a known staircase with a single sweep. Returns false if the full step up is needed. */
+	virtual bool TryPredictiveStairStep(FCommonMoveData& WalkData);
+
+	/** Updates the staircase info on the blackboard after a full step up */
+	void UpdateStaircaseInfo(const FVector& PreStepUpLocation, const FVector& PostStepUpLocation) const;
 
-	/** Attempts to slide the updated component along a wall or other blocking, unclimbable obstacle */
-	virtual bool ApplySlideAlongWall(FCommonMoveData& WalkData, float MaxWalkableSlopeCosine, float MaxStepHeight);
+	/** Attempts to slide the updated component along a wall or other blocking, unclimbable obstacle.
+	 * Keeps track of every plane contacted during the frame and slides along the crease when wedged between two of them. */
+	virtual bool ApplySlideAlongWall(FCommonMoveData& WalkData);
 
 	/** Attempts to adjust the character vertically so it contacts the floor */
-	virtual bool ApplyFloorHeightAdjustment(FCommonMoveData& WalkData, float MaxWalkableSlopeCosine);
+	virtual bool ApplyFloorHeightAdjustment(FCommonMoveData& WalkData);
 
 	/** Applies corrections to the updated component's position while not moving. */
 	virtual bool ApplyIdleCorrections(FCommonMoveData& WalkData);
@@ -54,6 +142,21 @@ protected:
 	/** Handles any movement mode transitions as a result of falling */
 	virtual bool HandleFalling(FMoverTickEndData & OutputState, FMovementRecord & MoveRecord, FHitResult & Hit, float TimeAppliedSoFar);
 
+	/** Searches for the floor under the updated component, using the cheapest query that is safe for the current floor */
+	virtual void QueryFloor(FCommonMoveData& WalkData, FFloorCheckResult& OutFloorResult);
+
+	/** Attempts to compute the floor analytically from the landscape heightfield we were last standing on. Returns false if a sweep is needed. */
+	bool TryFindLandscapeFloor(const FCommonMoveData& WalkData, FFloorCheckResult& OutFloorResult) const;
+
+	/** Attempts to find the floor with a single line trace while standing on a simple floor. Returns false if a sweep is needed. */
+	bool TryFindSimpleFloor(const FCommonMoveData& WalkData, FFloorCheckResult& OutFloorResult) const;
+
+	/** Updates the floor simplicity tracking on the blackboard with the floor we ended up on */
+	void UpdateFloorSimplicity(const FFloorCheckResult& FloorResult) const;
+
+	/** Returns the shared walkability cache, or null if caching is disabled */
+	FCommonWalkabilityCache* GetWalkabilityCache() const;
+
 	/** Captures the final movement state for the simulation frame and updates the output default sync state */
 	void CaptureFinalState(const FFloorCheckResult& FloorResult, bool bDidAttemptMovement, const FMovementRecord& Record) const;
 
@@ -63,6 +166,123 @@ protected:
 	/** Returns the name of the movement mode that will handle falling*/
 	virtual const FName& GetFallingModeName() const;
 
+protected:
+	/** If true, the step up answer of static geometry whose owner decides it will be shared between all movers in the world.
+	 * Only worth it if those owners override CanBeBaseForCharacter with something expensive. */
+	UPROPERTY(Category=Mover, EditAnywhere, BlueprintReadWrite)
+	bool bUseWalkabilityCache = false;
+
+	/** Maximum number of depenetration attempts per simulation frame */
+	UPROPERTY(Category=Mover, EditAnywhere, BlueprintReadWrite, meta=(ClampMin=1))
+	int32 MaxDepenetrationIterations = 4;
+
+	/** Maximum total distance we can be pushed out of geometry per simulation frame */
+	UPROPERTY(Category=Mover, EditAnywhere, BlueprintReadWrite, meta=(ClampMin=0, ForceUnits="cm"))
+	float MaxDepenetrationDistance = 50.0f;
+
+	/** If true, regular staircases will be detected and climbed with a single predictive sweep per step */
+	UPROPERTY(Category=Mover, EditAnywhere, BlueprintReadWrite)
+	bool bUseStaircasePrediction = true;
+
+	/** Number of consecutive matching step ups before a staircase is predicted. The direction is only known after the second step. */
+	UPROPERTY(Category=Mover, EditAnywhere, BlueprintReadWrite, meta=(ClampMin=2, EditCondition="bUseStaircasePrediction"))
+	int32 StaircaseMinSteps = 2;
+
+	/** Maximum difference in rise or run between two steps of the same staircase */
+	UPROPERTY(Category=Mover, EditAnywhere, BlueprintReadWrite, meta=(ClampMin=0, ForceUnits="cm", EditCondition="bUseStaircasePrediction"))
+	float StaircaseTolerance = 3.0f;
+
+	/** If true, overlapping movers push each other apart softly instead of blocking each other's sweeps. Requires the spatial hash. */
+	UPROPERTY(Category=Mover, EditAnywhere, BlueprintReadWrite)
+	bool bUsePawnSeparation = false;
+
+	/** If true, the updated component will overlap instead of block the pawn channel while this mode is registered, so pawns don't get swept against.
+	 * This changes the collision response of the updated component itself, so every other pawn stops being blocked by it as well. */
+	UPROPERTY(Category=Mover, EditAnywhere, BlueprintReadWrite, meta=(EditCondition="bUsePawnSeparation"))
+	bool bIgnorePawnsInSweeps = true;
+
+	/** Collision channel of the pawns we separate from instead of sweeping against */
+	UPROPERTY(Category=Mover, EditAnywhere, BlueprintReadWrite, meta=(EditCondition="bUsePawnSeparation && bIgnorePawnsInSweeps"))
+	TEnumAsByte<ECollisionChannel> PawnSeparationChannel = ECC_Pawn;
+
+	/** Fraction of the overlap resolved per simulation frame. Each mover resolves its half of the overlap. */
+	UPROPERTY(Category=Mover, EditAnywhere, BlueprintReadWrite, meta=(ClampMin=0, ClampMax=1, EditCondition="bUsePawnSeparation"))
+	float PawnSeparationStiffness = 0.5f;
+
+	/** Maximum speed we can be pushed at by other movers */
+	UPROPERTY(Category=Mover, EditAnywhere, BlueprintReadWrite, meta=(ClampMin=0, ForceUnits="cm/s", EditCondition="bUsePawnSeparation"))
+	float MaxPawnSeparationSpeed = 300.0f;
+
+	/** Maximum number of overlapping movers we separate from per simulation frame */
+	UPROPERTY(Category=Mover, EditAnywhere, BlueprintReadWrite, meta=(ClampMin=1, EditCondition="bUsePawnSeparation"))
+	int32 MaxPawnSeparationNeighbors = 8;
+
+	/** Moves shorter than this are deferred and added up across frames, until they're long enough to sweep or the input changes. Zero disables it. */
+	UPROPERTY(Category=Mover, EditAnywhere, BlueprintReadWrite, meta=(ClampMin=0, ForceUnits="cm"))
+	float MinMovementThreshold = 0.0f;
+
+	/** Maximum number of frames a move can be deferred for by MinMovementThreshold. The accumulated move is applied once it's reached. */
+	UPROPERTY(Category=Mover, EditAnywhere, BlueprintReadWrite, meta=(ClampMin=1))
+	int32 MaxCoalescedFrames = 4;
+
+	/** If true, fast moves will be split into substeps no longer than MaxSubstepDistance */
+	UPROPERTY(Category=Mover, EditAnywhere, BlueprintReadWrite)
+	bool bUseSubstepping = true;
+
+	/** Maximum distance moved per substep. If zero, the capsule radius is used. */
+	UPROPERTY(Category=Mover, EditAnywhere, BlueprintReadWrite, meta=(ClampMin=0, ForceUnits="cm", EditCondition="bUseSubstepping"))
+	float MaxSubstepDistance = 0.0f;
+
+	/** Maximum number of substeps per simulation frame */
+	UPROPERTY(Category=Mover, EditAnywhere, BlueprintReadWrite, meta=(ClampMin=1, EditCondition="bUseSubstepping"))
+	int32 MaxSubstepsPerTick = 4;
+
+	/** Once this many sweeps have been used in a frame, the rest of the move is applied in a single substep */
+	UPROPERTY(Category=Mover, EditAnywhere, BlueprintReadWrite, meta=(ClampMin=1, EditCondition="bUseSubstepping"))
+	int32 MaxSweepsPerTick = 24;
+
+	/** Maximum number of sweeps used to slide along walls per simulation frame, shared by all substeps.
+	 * The first slide against a wall counts as two, since it may adjust against a second wall. */
+	UPROPERTY(Category=Mover, EditAnywhere, BlueprintReadWrite, meta=(ClampMin=1))
+	int32 MaxSlideSweepsPerTick = 5;
+
+	/** Sliding stops once the remaining move is shorter than this */
+	UPROPERTY(Category=Mover, EditAnywhere, BlueprintReadWrite, meta=(ClampMin=0, ForceUnits="cm"))
+	float MinSlideDelta = 0.1f;
+
+	/** Riders whose base moves them further than this relative to the base's own translation (i.e. by its rotation) sweep there instead of moving kinematically.
+	 * Pure translation never counts, so riders on fast bases still skip the sweep. Any penetration is resolved by the first move of the frame,
+	 * or by the floor query of idle riders, which is always a full sweep after a kinematic base move. */
+	UPROPERTY(Category=Mover, EditAnywhere, BlueprintReadWrite, meta=(ClampMin=0, ForceUnits="cm"))
+	float MaxKinematicBaseMoveDistance = 20.0f;
+
+	/** If true, floors on landscapes will be sampled from the heightfield instead of sweeping. Holes and component borders fall back to the sweep. */
+	UPROPERTY(Category=Mover, EditAnywhere, BlueprintReadWrite)
+	bool bUseAnalyticLandscapeFloor = true;
+
+	/** A full floor sweep will be forced every this many simulation frames while on a landscape, to catch any geometry placed under us */
+	UPROPERTY(Category=Mover, EditAnywhere, BlueprintReadWrite, meta=(ClampMin=1, EditCondition="bUseAnalyticLandscapeFloor"))
+	int32 AnalyticFloorRevalidationInterval = 10;
+
+	/** If true, the floor will be found with a line trace instead of a sweep while standing on a flat, static floor */
+	UPROPERTY(Category=Mover, EditAnywhere, BlueprintReadWrite)
+	bool bUseLineTraceOnSimpleFloors = true;
+
+	/** Number of consecutive frames the floor needs to stay the same before we switch to line traces */
+	UPROPERTY(Category=Mover, EditAnywhere, BlueprintReadWrite, meta=(ClampMin=1, EditCondition="bUseLineTraceOnSimpleFloors"))
+	int32 SimpleFloorStableFrames = 5;
+
+	/** Minimum up component of the floor normal for the floor to count as flat */
+	UPROPERTY(Category=Mover, EditAnywhere, BlueprintReadWrite, meta=(ClampMin=0, ClampMax=1, EditCondition="bUseLineTraceOnSimpleFloors"))
+	float SimpleFloorMinNormalZ = 0.999f;
+
+	/** Maximum change in floor distance between two frames before the floor counts as a discontinuity */
+	UPROPERTY(Category=Mover, EditAnywhere, BlueprintReadWrite, meta=(ClampMin=0, ForceUnits="cm", EditCondition="bUseLineTraceOnSimpleFloors"))
+	float SimpleFloorMaxHeightChange = 1.0f;
+
+	/** Pawn channel this mode holds an overlap override on, so it can be released with the same channel */
+	TOptional<ECollisionChannel> HeldPawnChannel;
+
 protected:
 	///////////////////////////////////////////////////////////////
 	// Transient variables used by the simulation stages
@@ -72,4 +292,13 @@ protected:
 	/** Floor info structs */
 	FFloorCheckResult CurrentFloor;
 	FRelativeBaseInfo OldRelativeBase;
+
+	/** True if this frame's move got deferred by CoalesceMicroMovement */
+	bool bIsMoveCoalesced = false;
+
+	/** True if the base carried us this frame without a sweep, so the next floor query has to be a full sweep */
+	bool bMovedKinematicallyWithBase = false;
+
+	/** Velocity the pawn separation push adds to this frame's move, kept out of the final velocity */
+	FVector SeparationVelocity = FVector::ZeroVector;
 };
@@ -3,6 +3,8 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "CommonMovementModeIds.h"
+#include "CommonMoverLODSyncState.h"
 #include "GameplayTagSyncState.h"
 #include "MovementMode.h"
 #include "DefaultMovementSet/Settings/CommonLegacyMovementSettings.h"
@@ -32,9 +34,49 @@ struct FCommonMoveData
 
 	/** Percentage of the simulation time slice we've used so far while moving. */
 	float PercentTimeAppliedSoFar = 0.0f;
+
+	/** Number of sweeps and traces used so far in the frame. */
+	int32 NumSweeps = 0;
+
+	/** Number of those sweeps used to slide along walls, across all substeps of the frame. */
+	int32 NumSlideSweeps = 0;
 };
 
-/** Provides a common structure for movement modes. */
+/** Packed copy of the shared movement settings read by the simulation stages.
+ * Built when the mode gets registered and only rebuilt when the settings change, so the stages don't look them up every tick.
+ * Edits in the editor are picked up automatically. Runtime changes to the shared settings or the mode's tuning
+ * need a call to UCommonMoverComponent::NotifyMovementSettingsChanged, which bumps the revision every snapshot is checked against. */
+struct FCommonMovementSettingsSnapshot
+{
+	/** Settings object the snapshot was built from */
+	TWeakObjectPtr<const UCommonLegacyMovementSettings> Source;
+
+	/** Movement settings revision of the mover component when the snapshot was built */
+	uint32 Revision = 0;
+
+	/** Max surface incline the owner can walk on, as the cosine of its angle */
+	float MaxWalkSlopeCosine = 0.71f;
+
+	/** Max height the owner can step up onto */
+	float MaxStepHeight = 40.0f;
+
+	/** How far down we look for a floor */
+	float FloorSweepDistance = 40.0f;
+
+	/** Whether the owner always stays upright */
+	bool bShouldRemainVertical = true;
+
+	/** Squared thresholds derived from the mode's own tuning, filled in by the modes that use them */
+	float MinMovementThresholdSquared = 0.0f;
+	float MinSlideDeltaSquared = 0.0f;
+	float MaxKinematicBaseMoveDistanceSquared = 0.0f;
+
+	/** Returns true if the snapshot was built from settings that still exist */
+	bool IsValid() const { return Source.IsValid(); }
+};
+
+/** Provides a common structure for movement modes.
+ * Modes only run on the game thread. They move components directly and share caches with other movers in the world without any locking. */
 UCLASS(Abstract)
 class COMMONMOVER_API UCommonMovementMode
 	: public UBaseMovementMode
@@ -57,6 +99,12 @@ public:
 	virtual void OnRegistered(const FName ModeName) override;
 	virtual void OnUnregistered() override;
 
+	/** Returns the compact ID this mode was registered with */
+	FCommonMovementModeId GetModeId() const { return ModeId; }
+
+	/** Marks the settings snapshot of this mode as outdated, so it gets rebuilt before the next simulation tick */
+	void InvalidateSettingsSnapshot() { SettingsSnapshot.Source.Reset(); }
+
 	//~ Begin IVisualLoggerDebugSnapshotInterface
 #if ENABLE_VISUAL_LOG
 	virtual void GrabDebugSnapshot(struct FVisualLogEntry* Snapshot) const override;
@@ -82,6 +130,12 @@ protected:
 	/** Handles any additional behaviors after the updated component's final position and velocity have been computed */
 	virtual void PostMove(FMoverTickEndData& OutputState);
 
+	/** Extrapolates the starting state along its velocity without sweeping. Used by distant simulated proxies. */
+	virtual void ApplyExtrapolationOnly(FMoverTickEndData& OutputState);
+
+	/** Returns true if this frame should skip the expensive stages and only move and clamp to the ground */
+	bool ShouldUseGroundClampOnly() const;
+
 	/** Attempts to teleport the updated component */
 	virtual bool AttemptTeleport(const FVector& TeleportPos, const FRotator& TeleportRot, const FVector& PriorVelocity);
 
@@ -91,11 +145,28 @@ protected:
 	/** Calculates the target orientation Quat for the movement. Returns true if there is a change in orientation. */
 	virtual bool CalculateOrientationChange(FQuat& TargetOrientQuat);
 
+	/** Rebuilds the settings snapshot from the mover component's shared settings and the mode's tuning. Returns false if there are no settings. */
+	virtual bool RefreshSettingsSnapshot();
+
+	/** Returns true if the settings snapshot needs to be rebuilt before simulating */
+	bool IsSettingsSnapshotOutdated() const;
+
 protected:
 	/** Tag to add while this mode is active */
 	UPROPERTY(Category=Mover, EditAnywhere, BlueprintReadWrite)
 	FGameplayTag ModeTag;
 
+	/** Compact ID assigned by the mover component when this mode got registered */
+	FCommonMovementModeId ModeId = CommonMovementModeIds::Invalid;
+
+	/** Settings read by the simulation stages */
+	FCommonMovementSettingsSnapshot SettingsSnapshot;
+
+#if WITH_EDITOR
+	/** Used to rebuild the settings snapshot when the settings get edited */
+	FDelegateHandle SettingsChangedHandle;
+#endif
+
 
 
 	///////////////////////////////////////////////////////////////
@@ -124,9 +195,10 @@ protected:
 	/** Pointer to the proposed move for this simulation step */
 	const FProposedMove* ProposedMove;
 
-	/** Mutable pointers to the output sync states */
+	/** Mutable pointers to the output sync states. The LOD state is null unless the mover has simulation LOD enabled. */
 	FMoverDefaultSyncState* OutDefaultSyncState;
 	FGameplayTagsSyncState* OutTagsSyncState;
+	FCommonMoverLODSyncState* OutLODSyncState;
 
 	/** Utility velocity values */
 	FVector StartingVelocity;
@@ -135,4 +207,13 @@ protected:
 	float DeltaMs;
 	float DeltaTime;
 	float CurrentSimulationTime;
+
+	/** Simulation frame number, used to schedule reduced LOD work deterministically across resimulations */
+	int32 CurrentSimulationFrame;
+
+	/** Simulation level of detail of the starting sync state */
+	ECommonMoverSimulationLOD SimulationLOD;
+
+	/** True while re-running a frame after a correction. Gameplay events already fired the first time, so they must not fire again. */
+	bool bIsResimulating;
 };
@@ -0,0 +1,21 @@
+// Copyright © 2024 MajorT. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Compact integer ID of a movement mode, assigned when the mode registers with a UCommonMoverComponent.
+ * Meant for storing modes compactly outside the simulation. Mover transitions and replicates modes by name,
+ * and an FName compare is already a single integer compare, so the simulation checks and sets modes by name. */
+using FCommonMovementModeId = uint8;
+
+/** Well known movement mode IDs. These are always assigned to the matching DefaultModeNames. */
+namespace CommonMovementModeIds
+{
+	inline constexpr FCommonMovementModeId Walking = 0;
+	inline constexpr FCommonMovementModeId Falling = 1;
+	inline constexpr FCommonMovementModeId Flying = 2;
+	inline constexpr FCommonMovementModeId Swimming = 3;
+
+	inline constexpr FCommonMovementModeId Invalid = MAX_uint8;
+}
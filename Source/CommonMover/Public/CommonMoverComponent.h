@@ -3,11 +3,17 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "CommonMovementModeIds.h"
+#include "CommonMoverLODSyncState.h"
 #include "MoverComponent.h"
+#include "Library/CommonMoverCollectionUtils.h"
+#include "Library/CommonMoverPrediction.h"
 #include "VisualLogger/VisualLoggerDebugSnapshotInterface.h"
 
 #include "CommonMoverComponent.generated.h"
 
+class UCommonMoverSpatialHashSubsystem;
+
 /** Fired after the actor lands on a valid surface.
  * The first param is the name of the mode this actor is in after landing.
  * The second param is the hit result from hitting the floor. */
@@ -34,6 +40,7 @@ protected:
 
 	//~ Begin UObject Interface
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	//~ End UObject Interface
 
 	/** Applies forces to physical objects on impact */
@@ -54,6 +61,24 @@ public:
 
 	void SetMovementDisabled(bool bState);
 
+	/** Returns the owner to a freshly spawned state at the given transform and velocity, without registering the movement modes again.
+	 * Clears the blackboard, movement tags, layered moves and the teleport and disabled flags, and switches back to the starting movement mode.
+	 * Returns false if the sync state couldn't be written. */
+	bool ResetMoverState(const FVector& Location, const FRotator& Orientation, const FVector& Velocity = FVector::ZeroVector);
+
+	/** Enables or disables ticking of this component and of the owner's backend liaison, which drives the simulation */
+	void SetSimulationTickEnabled(bool bEnabled);
+
+	/** Sets the tick interval of this component and of the owner's backend liaison. Zero ticks every frame. */
+	void SetSimulationTickInterval(float TickInterval);
+
+	/** Makes the updated component overlap the channel instead of blocking it.
+	 * Reference counted, so every mode that needs it can hold it independently. */
+	void AcquireChannelOverlap(ECollisionChannel Channel);
+
+	/** Releases a hold taken with AcquireChannelOverlap. The original response comes back once nobody holds the channel anymore. */
+	void ReleaseChannelOverlap(ECollisionChannel Channel);
+
 	/** Returns true if the owner is currently falling */
 	UFUNCTION(BlueprintPure, Category="Mover")
 	virtual bool IsFalling() const;
@@ -102,6 +127,74 @@ public:
 	UFUNCTION(BlueprintPure, Category="Mover")
 	FVector GetGroundNormal() const;
 
+	/** Returns the simulation level of detail of the current sync state */
+	UFUNCTION(BlueprintPure, Category="Mover|LOD")
+	ECommonMoverSimulationLOD GetSimulationLOD() const;
+
+	/** Re-evaluates the simulation level of detail based on the distance to the closest viewer */
+	UFUNCTION(BlueprintCallable, Category="Mover|LOD")
+	void UpdateSimulationLOD();
+
+	/** Predicts where this mover will end up without moving it. Returns false if no prediction could be made. */
+	UFUNCTION(BlueprintCallable, Category="Mover|Prediction")
+	bool PredictTrajectory(const FCommonMoverPredictionParams& Params, TArray<FCommonMoverPredictionSample>& OutSamples) const;
+
+	/** Returns prediction params starting from the current state of this mover */
+	UFUNCTION(BlueprintPure, Category="Mover|Prediction")
+	FCommonMoverPredictionParams MakePredictionParams(FVector MoveInput, float Duration) const;
+
+	/** Captures everything a prediction needs to know about this mover, so it can be used with FCommonMoverPrediction::PredictBatch */
+	bool MakePredictionContext(FCommonMoverPredictionContext& OutContext) const;
+
+	/** Returns the ID of a movement mode name, assigning a new one if the name hasn't been seen yet */
+	FCommonMovementModeId RegisterMovementModeId(const FName& ModeName);
+
+	/** Returns the ID of a movement mode name, or CommonMovementModeIds::Invalid if it was never registered.
+	 * This searches the ID table, so the simulation compares names directly instead. */
+	FCommonMovementModeId FindMovementModeId(const FName& ModeName) const;
+
+	/** Returns the name of a movement mode by its ID, or NAME_None if there is no such ID */
+	FName GetMovementModeNameById(FCommonMovementModeId ModeId) const;
+
+	/** Returns the ID of the current movement mode */
+	FCommonMovementModeId GetCurrentMovementModeId() const { return FindMovementModeId(GetMovementModeName()); }
+
+	/** Adds this mover to the world's spatial hash, if bRegisterInSpatialHash is set */
+	void RegisterInSpatialHash();
+
+	/** Removes this mover from the spatial hash it's registered in */
+	void UnregisterFromSpatialHash();
+
+	/** Updates our location in the spatial hash, if we're registered in it */
+	void UpdateSpatialHashLocation(const FVector& Location);
+
+	/** Returns the spatial hash we're registered in, if any */
+	UCommonMoverSpatialHashSubsystem* GetSpatialHash() const { return SpatialHash.Get(); }
+
+	/** Call after changing the shared movement settings or the tuning of a CommonMover mode at runtime, so every mode rebuilds its settings snapshot */
+	UFUNCTION(BlueprintCallable, Category="Mover")
+	void NotifyMovementSettingsChanged() { ++MovementSettingsRevision; }
+
+	/** Returns the revision of the movement settings, bumped on every NotifyMovementSettingsChanged */
+	uint32 GetMovementSettingsRevision() const { return MovementSettingsRevision; }
+
+	/** Returns the collection slots shared by all CommonMover modes of this component */
+	FCommonCollectionSlotCache& GetCollectionSlotCache() { return CollectionSlotCache; }
+
+protected:
+	/** Returns the distance to the closest player viewpoint, or MAX_flt if there are no viewers */
+	float GetDistanceToClosestViewer() const;
+
+	/** Picks the LOD tier for the given viewer distance, applying hysteresis against the current tier */
+	ECommonMoverSimulationLOD ComputeSimulationLOD(float ViewerDistance) const;
+
+	/** Writes the LOD tier into the pending sync state, so the simulation picks it up on its next frame, and applies the tier's tick rate */
+	void SetSimulationLOD(ECommonMoverSimulationLOD NewLOD);
+
+	/** Keeps our spot in the spatial hash up to date after every finalized frame, whatever mode or role produced it */
+	UFUNCTION()
+	void OnPostFinalizeUpdateSpatialHash(const FMoverSyncState& SyncState, const FMoverAuxStateContext& AuxState);
+
 protected:
 	/** Broadcasted when this actor lands on a valid surface. */
 	UPROPERTY(BlueprintAssignable, Category = Mover)
@@ -116,4 +209,65 @@ protected:
 
 	/** Set to true while movement has been disabled externally */
 	bool bDisableMovement = false;
+
+public:
+	/** If true, this mover will be registered in the spatial hash, so it can be found by proximity queries */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Mover|Spatial")
+	bool bRegisterInSpatialHash = true;
+
+	/** If true, the simulation level of detail will be updated based on the distance to the closest viewer */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Mover|LOD")
+	bool bEnableSimulationLOD = false;
+
+	/** Viewer distance beyond which the simulation is reduced */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Mover|LOD", meta=(ClampMin=0, ForceUnits="cm", EditCondition="bEnableSimulationLOD"))
+	float ReducedLODDistance = 3000.0f;
+
+	/** Viewer distance beyond which the simulation only moves and clamps to the ground */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Mover|LOD", meta=(ClampMin=0, ForceUnits="cm", EditCondition="bEnableSimulationLOD"))
+	float GroundClampLODDistance = 6000.0f;
+
+	/** Viewer distance beyond which simulated proxies only extrapolate */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Mover|LOD", meta=(ClampMin=0, ForceUnits="cm", EditCondition="bEnableSimulationLOD"))
+	float ExtrapolateLODDistance = 10000.0f;
+
+	/** Distance a viewer needs to move back past a threshold before we return to a more detailed tier. Prevents tier flickering. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Mover|LOD", meta=(ClampMin=0, ForceUnits="cm", EditCondition="bEnableSimulationLOD"))
+	float LODHysteresisDistance = 300.0f;
+
+	/** Time between simulation LOD updates */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Mover|LOD", meta=(ClampMin=0.01, ForceUnits="s", EditCondition="bEnableSimulationLOD"))
+	float LODUpdateInterval = 0.25f;
+
+	/** Tick interval of the Reduced tier. Each tick then simulates a longer step.
+	 * Only affects backends that step with the component tick, like the standalone liaison. Fixed tick backends keep their rate. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Mover|LOD", meta=(ClampMin=0, ForceUnits="s", EditCondition="bEnableSimulationLOD"))
+	float ReducedLODTickInterval = 0.05f;
+
+protected:
+	/** Timer used to periodically update the simulation level of detail */
+	FTimerHandle SimulationLODTimerHandle;
+
+	/** Movement mode names indexed by their ID */
+	TArray<FName, TInlineAllocator<8>> MovementModeIdTable;
+
+	/** Collection slots resolved by the movement modes. Shared so mode transitions don't resolve them again. */
+	FCommonCollectionSlotCache CollectionSlotCache;
+
+	/** Bumped whenever the movement settings change at runtime, so the modes know to rebuild their settings snapshots */
+	uint32 MovementSettingsRevision = 0;
+
+	/** Spatial hash we're registered in */
+	TWeakObjectPtr<UCommonMoverSpatialHashSubsystem> SpatialHash;
+
+	/** Channel response we replaced on the updated component, and how many holds are keeping it replaced */
+	struct FChannelOverlapOverride
+	{
+		TWeakObjectPtr<UPrimitiveComponent> Primitive;
+		ECollisionResponse OriginalResponse = ECR_Block;
+		int32 NumHolds = 0;
+	};
+
+	/** Channel overrides held by the movement modes */
+	TMap<ECollisionChannel, FChannelOverlapOverride> ChannelOverlapOverrides;
 };
@@ -0,0 +1,61 @@
+// Copyright © 2024 MajorT. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MoverTypes.h"
+
+#include "CommonMoverLODSyncState.generated.h"
+
+/** Simulation level of detail tiers, from most to least expensive. */
+UENUM(BlueprintType)
+enum class ECommonMoverSimulationLOD : uint8
+{
+	/** Runs the full simulation pipeline every frame */
+	Full,
+
+	/** Runs the full pipeline at a lower tick rate, see ReducedLODTickInterval */
+	Reduced,
+
+	/** Only moves and clamps to the ground. Ramps, step ups and wall slides are skipped */
+	GroundClampOnly,
+
+	/** Simulated proxies only extrapolate their last state along its velocity, without collision. Ground modes still clamp it to the floor with a single floor query */
+	ExtrapolateOnly
+};
+
+/** Extends the mover sync state with the simulation level of detail.
+ * The tier is picked on the game thread, but the simulation only reads it from here, so resimulated frames run at the tier they were first simulated with. */
+USTRUCT(BlueprintType)
+struct COMMONMOVER_API FCommonMoverLODSyncState : public FMoverDataStructBase
+{
+	GENERATED_BODY()
+
+public:
+	FCommonMoverLODSyncState();
+	virtual ~FCommonMoverLODSyncState() override = default;
+
+	//~ Begin FMoverDataStructBase Interface
+	virtual FMoverDataStructBase* Clone() const override;
+	virtual bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess) override;
+	virtual UScriptStruct* GetScriptStruct() const override;
+	virtual void ToString(FAnsiStringBuilderBase& Out) const override;
+	virtual bool ShouldReconcile(const FMoverDataStructBase& AuthorityState) const override;
+	virtual void Interpolate(const FMoverDataStructBase& From, const FMoverDataStructBase& To, float Pct) override;
+	//~ End FMoverDataStructBase Interface
+
+public:
+	/** Simulation level of detail to run the next frame at */
+	UPROPERTY(BlueprintReadOnly, Category = "Mover|LOD")
+	ECommonMoverSimulationLOD SimulationLOD = ECommonMoverSimulationLOD::Full;
+};
+
+template<>
+struct TStructOpsTypeTraits< FCommonMoverLODSyncState > : public TStructOpsTypeTraitsBase2< FCommonMoverLODSyncState >
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithCopy = true
+	};
+};
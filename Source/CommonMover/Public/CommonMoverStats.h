@@ -0,0 +1,27 @@
+// Copyright © 2024 MajorT. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("CommonMover"), STATGROUP_CommonMover, STATCAT_Advanced);
+
+/** Floor queries */
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Floor Sweeps"), STAT_CommonMover_FloorSweeps, STATGROUP_CommonMover, COMMONMOVER_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Floor Line Traces"), STAT_CommonMover_FloorLineTraces, STATGROUP_CommonMover, COMMONMOVER_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Floor Landscape Samples"), STAT_CommonMover_FloorLandscapeSamples, STATGROUP_CommonMover, COMMONMOVER_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Floor Line Trace Escalations"), STAT_CommonMover_FloorLineTraceEscalations, STATGROUP_CommonMover, COMMONMOVER_API);
+
+/** Depenetration */
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Depenetration Iterations"), STAT_CommonMover_DepenetrationIterations, STATGROUP_CommonMover, COMMONMOVER_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Stuck Pawns"), STAT_CommonMover_StuckPawns, STATGROUP_CommonMover, COMMONMOVER_API);
+
+/** Wall slides */
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Slide Sweeps"), STAT_CommonMover_SlideSweeps, STATGROUP_CommonMover, COMMONMOVER_API);
+
+/** Pawn separation */
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Pawn Separation Pushes"), STAT_CommonMover_PawnSeparationPushes, STATGROUP_CommonMover, COMMONMOVER_API);
+
+/** Micro-movement coalescing */
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Coalesced Moves"), STAT_CommonMover_CoalescedMoves, STATGROUP_CommonMover, COMMONMOVER_API);
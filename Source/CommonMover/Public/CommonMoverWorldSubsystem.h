@@ -0,0 +1,28 @@
+// Copyright © 2024 MajorT. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Library/CommonWalkabilityCache.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "CommonMoverWorldSubsystem.generated.h"
+
+/** Holds data shared by every CommonMover in the world, so work done for one mover can be reused by the others. */
+UCLASS()
+class COMMONMOVER_API UCommonMoverWorldSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	//~ Begin UWorldSubsystem Interface
+	virtual void Deinitialize() override;
+	//~ End UWorldSubsystem Interface
+
+	/** Returns the walkability cache for static geometry */
+	FCommonWalkabilityCache& GetWalkabilityCache() { return WalkabilityCache; }
+
+protected:
+	/** Step up results for static geometry whose owner decides them */
+	FCommonWalkabilityCache WalkabilityCache;
+};
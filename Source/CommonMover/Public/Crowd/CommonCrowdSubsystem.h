@@ -0,0 +1,196 @@
+// Copyright © 2024 MajorT. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "CommonCrowdSubsystem.generated.h"
+
+class ACommonMoverPawn;
+class ALandscapeProxy;
+class UCommonLegacyMovementSettings;
+
+/** Fired when a crowd agent gets promoted to a full mover pawn.
+ * The first param is the id of the agent that was removed from the crowd.
+ * The second param is the pawn that replaced it. */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FCommonCrowdEvent_OnAgentPromoted, int32, AgentId, ACommonMoverPawn*, Pawn);
+
+/** Structure-of-arrays storage for crowd agents.
+ * Every array is kept at the same length and padded to a multiple of the SIMD width, so the integration can run 4 agents at a time. */
+struct FCommonCrowdAgentBuffers
+{
+	/** Positions */
+	TArray<float> PosX;
+	TArray<float> PosY;
+	TArray<float> PosZ;
+
+	/** Current velocities on the ground plane */
+	TArray<float> VelX;
+	TArray<float> VelY;
+
+	/** Desired velocities on the ground plane */
+	TArray<float> DesiredVelX;
+	TArray<float> DesiredVelY;
+
+	/** Last resolved floor height */
+	TArray<float> FloorZ;
+
+	/** Ground plane position before the last integration, used to undo a move that climbed too high */
+	TArray<float> PrevPosX;
+	TArray<float> PrevPosY;
+
+	/** Id of the agent stored at each dense index */
+	TArray<int32> AgentIds;
+
+	/** Promotion grid cell each agent is stored in */
+	TArray<FIntPoint> Cells;
+
+	/** Number of live agents. Entries past this are padding. */
+	int32 Num = 0;
+
+	/** Adds an agent and returns its dense index */
+	int32 Add(int32 AgentId, const FVector& Location);
+
+	/** Removes the agent at the dense index by swapping the last agent into it. Returns the id of the moved agent, or INDEX_NONE. */
+	int32 RemoveAtSwap(int32 DenseIndex);
+
+	/** Returns the location of the agent at the dense index */
+	FVector GetLocation(int32 DenseIndex) const { return FVector(PosX[DenseIndex], PosY[DenseIndex], PosZ[DenseIndex]); }
+
+private:
+	/** Grows every array to hold at least the given number of agents, rounded up to the SIMD width */
+	void Reserve(int32 NewNum);
+};
+
+/** Cheap ground movement for large ambient crowds.
+ * Agents are kept in SoA buffers, integrated with SIMD, and get their height from the landscape or the navmesh instead of capsule sweeps.
+ * Agents get promoted to a full CommonMover pawn once a player gets close.
+ * Movement limits are read from a CommonLegacyMovementSettings object, so crowds behave like regular ground movers. */
+UCLASS()
+class COMMONMOVER_API UCommonCrowdSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	//~ Begin UWorldSubsystem Interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	//~ End UWorldSubsystem Interface
+
+	//~ Begin FTickableGameObject Interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	//~ End FTickableGameObject Interface
+
+	/** Adds an agent to the crowd and returns its id */
+	UFUNCTION(BlueprintCallable, Category="Mover|Crowd")
+	int32 AddAgent(const FVector& Location);
+
+	/** Removes an agent from the crowd */
+	UFUNCTION(BlueprintCallable, Category="Mover|Crowd")
+	void RemoveAgent(int32 AgentId);
+
+	/** Sets the velocity the agent will try to reach */
+	UFUNCTION(BlueprintCallable, Category="Mover|Crowd")
+	void SetAgentDesiredVelocity(int32 AgentId, const FVector& DesiredVelocity);
+
+	/** Returns the current location of the agent, or a zero vector if the agent doesn't exist */
+	UFUNCTION(BlueprintPure, Category="Mover|Crowd")
+	FVector GetAgentLocation(int32 AgentId) const;
+
+	/** Returns the number of agents in the crowd */
+	UFUNCTION(BlueprintPure, Category="Mover|Crowd")
+	int32 GetNumAgents() const { return Agents.Num; }
+
+	/** Sets the movement settings shared with the regular mover pawns */
+	UFUNCTION(BlueprintCallable, Category="Mover|Crowd")
+	void SetMovementSettings(UCommonLegacyMovementSettings* InSettings);
+
+	/** Replaces a pawn with a crowd agent at its location. Returns the new agent id.
+	 * The agent won't be promoted again until it has been out of the promotion distance of every player. */
+	UFUNCTION(BlueprintCallable, Category="Mover|Crowd")
+	int32 DemotePawn(ACommonMoverPawn* Pawn);
+
+public:
+	/** Pawn class spawned when an agent gets promoted. Promotion is disabled if unset. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Mover|Crowd")
+	TSubclassOf<ACommonMoverPawn> PromotionPawnClass;
+
+	/** Agents closer than this to a player get promoted to a full mover pawn */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Mover|Crowd", meta=(ClampMin=0, ForceUnits="cm"))
+	float PromotionDistance = 2500.0f;
+
+	/** Half height of the agent capsule. Used to place agents above the floor. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Mover|Crowd", meta=(ClampMin=0, ForceUnits="cm"))
+	float AgentHalfHeight = 88.0f;
+
+	/** Maximum number of floor heights resolved per tick. Remaining agents keep their last floor height until their turn comes. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Mover|Crowd", meta=(ClampMin=1))
+	int32 MaxHeightQueriesPerTick = 256;
+
+	/** Size of the grid cells agents are bucketed in, so promotion only looks at agents around the players */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Mover|Crowd", meta=(ClampMin=1, ForceUnits="cm"))
+	float AgentCellSize = 1000.0f;
+
+	/** Maximum number of agents promoted per tick. Remaining agents get promoted on the next ticks, so a player running into a crowd doesn't spawn it all at once. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Mover|Crowd", meta=(ClampMin=1))
+	int32 MaxPromotionsPerTick = 4;
+
+	/** Broadcast after an agent has been promoted to a full mover pawn */
+	UPROPERTY(BlueprintAssignable, Category="Mover|Crowd")
+	FCommonCrowdEvent_OnAgentPromoted OnAgentPromoted;
+
+protected:
+	/** Integrates velocities and positions of every agent on the ground plane */
+	void IntegrateAgents(float DeltaTime);
+
+	/** Resolves the floor height for a budgeted slice of agents and snaps them onto it */
+	void ResolveFloorHeights();
+
+	/** Samples the floor height under the given location, which is a step above the agent's current floor. Returns false if no floor was found. */
+	bool SampleFloorHeight(const FVector& Location, float& OutHeight) const;
+
+	/** Returns the promotion grid cell containing the location */
+	FIntPoint GetAgentCell(float X, float Y) const;
+
+	/** Moves the agents that changed cells since the last tick to their new cell */
+	void UpdateAgentCells();
+
+	/** Removes the agent id from the promotion grid cell */
+	void RemoveFromAgentCell(const FIntPoint& Cell, int32 AgentId);
+
+	/** Promotes every agent close to a player to a full mover pawn */
+	void PromoteAgentsNearPlayers();
+
+	/** Removes the agent from the crowd and spawns a mover pawn in its place */
+	ACommonMoverPawn* PromoteAgent(int32 AgentId);
+
+protected:
+	/** Movement settings shared with the full mover pawns */
+	UPROPERTY(Transient)
+	TObjectPtr<UCommonLegacyMovementSettings> MovementSettings;
+
+	/** Landscapes in the world, cached at begin play */
+	TArray<TWeakObjectPtr<ALandscapeProxy>> Landscapes;
+
+	/** Agent SoA buffers */
+	FCommonCrowdAgentBuffers Agents;
+
+	/** Maps agent ids to their dense index in the buffers */
+	TMap<int32, int32> AgentIdToIndex;
+
+	/** Next agent id to hand out */
+	int32 NextAgentId = 0;
+
+	/** Dense index of the next agent that gets its floor height resolved */
+	int32 HeightQueryCursor = 0;
+
+	/** Agents demoted while a player was close. They aren't promoted until they get out of the promotion distance. */
+	TSet<int32> PromotionBlockedAgents;
+
+	/** Agent ids in each occupied cell. Like the mover spatial hash, agents only touch it when they change cells. */
+	TMap<FIntPoint, TArray<int32, TInlineAllocator<8>>> AgentCells;
+};
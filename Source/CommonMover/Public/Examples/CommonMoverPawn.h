@@ -3,6 +3,7 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Containers/StaticArray.h"
 #include "InputAction.h"
 #include "MoverSimulationTypes.h"
 #include "GameFramework/Pawn.h"
@@ -11,6 +12,13 @@
 class UCapsuleComponent;
 class UCommonMoverComponent;
 
+/** Move input intent recorded at the world time it was triggered */
+struct FCommonMoveInputSample
+{
+	FVector MoveInputIntent = FVector::ZeroVector;
+	double Time = 0.0;
+};
+
 UCLASS(Abstract, NotPlaceable)
 class COMMONMOVER_API ACommonMoverPawn
 	: public APawn
@@ -22,6 +30,9 @@ public:
 	ACommonMoverPawn();
 
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
+	virtual void PossessedBy(AController* NewController) override;
+	virtual void UnPossessed() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	//~ Begin IMoverInputProducerInterface
 	virtual void ProduceInput_Implementation(int32 SimTimeMs, FMoverInputCmdContext& InputCmdResult) override;
@@ -35,9 +46,19 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Input)
 	TObjectPtr<UInputAction> MoveAction;
 
+	/** If true, input commands are produced as FCommonCharacterInputs, which are quantized and bit-packed when sent to the server */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Input)
+	bool bCompressInputs = false;
+
 	void Move(const FInputActionValue& Value);
 	void MoveCompleted(const FInputActionValue& Value);
 
+	/** Records the current move input intent in the sample ring */
+	void RecordMoveInputSample();
+
+	/** Returns the move input intent averaged over the last given seconds, weighted by how long each sample was held, and empties the sample ring */
+	FVector ConsumeMoveInputSamples(float WindowSeconds);
+
 private:
 	/** Mover component. */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category=Movement, meta=(AllowPrivateAccess=true))
@@ -52,4 +73,13 @@ private:
 
 	/* cached move variables */
 	FVector CachedMoveInputIntent = FVector::ZeroVector;
+
+	/* move input samples recorded since the last input command, oldest first starting at the head */
+	static constexpr int32 MaxMoveInputSamples = 16;
+	TStaticArray<FCommonMoveInputSample, MaxMoveInputSamples> MoveInputSamples;
+	int32 MoveInputSampleHead = 0;
+	int32 NumMoveInputSamples = 0;
+
+	/* move input intent held before the oldest sample in the ring */
+	FVector HeldMoveInputIntent = FVector::ZeroVector;
 };
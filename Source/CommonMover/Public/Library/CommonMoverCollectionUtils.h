@@ -0,0 +1,91 @@
+// Copyright © 2024 MajorT. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MoverSimulationTypes.h"
+
+/** Slots of the collection structs used by the CommonMover modes.
+ * Resolved once per collection layout and validated on every lookup, so a changed layout only costs a single search. */
+struct FCommonCollectionSlotCache
+{
+	/** Input collection */
+	int32 DefaultInputs = INDEX_NONE;
+
+	/** Starting sync state collection */
+	int32 DefaultSyncState = INDEX_NONE;
+	int32 TagsSyncState = INDEX_NONE;
+	int32 LODSyncState = INDEX_NONE;
+
+	/** Output sync state collection */
+	int32 OutDefaultSyncState = INDEX_NONE;
+	int32 OutTagsSyncState = INDEX_NONE;
+	int32 OutLODSyncState = INDEX_NONE;
+};
+
+namespace CommonMoverCollectionUtils
+{
+	/** Returns true if the data is of the requested type, or a type derived from it */
+	template<typename T>
+	bool IsDataOfType(const FMoverDataStructBase& Data)
+	{
+		return Data.GetScriptStruct()->IsChildOf(std::remove_const_t<T>::StaticStruct());
+	}
+
+	/** Returns the data at the cached slot if it still holds the requested type */
+	template<typename T>
+	T* GetDataAtSlot(const FMoverDataCollection& Collection, int32 Slot)
+	{
+		if (Slot == INDEX_NONE)
+		{
+			return nullptr;
+		}
+
+		auto It = Collection.GetCollectionDataIterator();
+		It += Slot;
+
+		if (It && It->IsValid() && IsDataOfType<T>(**It))
+		{
+			return static_cast<T*>(It->Get());
+		}
+
+		return nullptr;
+	}
+
+	/** Finds data by type, trying the cached slot before searching the collection and updating the slot if we had to search */
+	template<typename T>
+	T* FindDataByTypeCached(const FMoverDataCollection& Collection, int32& InOutSlot)
+	{
+		// Fast path, the layout didn't change
+		if (T* CachedData = GetDataAtSlot<T>(Collection, InOutSlot))
+		{
+			return CachedData;
+		}
+
+		// Slow path, search and remember where we found it
+		InOutSlot = INDEX_NONE;
+		for (auto It = Collection.GetCollectionDataIterator(); It; ++It)
+		{
+			if (It->IsValid() && IsDataOfType<T>(**It))
+			{
+				InOutSlot = It.GetIndex();
+				return static_cast<T*>(It->Get());
+			}
+		}
+
+		return nullptr;
+	}
+
+	/** Same as FindDataByTypeCached, but adds the data if the collection doesn't have it yet */
+	template<typename T>
+	T& FindOrAddMutableDataByTypeCached(FMoverDataCollection& Collection, int32& InOutSlot)
+	{
+		if (T* CachedData = FindDataByTypeCached<T>(Collection, InOutSlot))
+		{
+			return *CachedData;
+		}
+
+		// The slot gets resolved on the next lookup
+		return Collection.FindOrAddMutableDataByType<T>();
+	}
+}
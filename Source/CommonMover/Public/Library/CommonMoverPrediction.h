@@ -0,0 +1,158 @@
+// Copyright © 2024 MajorT. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CollisionQueryParams.h"
+#include "CollisionShape.h"
+#include "Engine/EngineTypes.h"
+
+#include "CommonMoverPrediction.generated.h"
+
+class UWorld;
+
+/** A single predicted point along a mover's trajectory */
+USTRUCT(BlueprintType)
+struct COMMONMOVER_API FCommonMoverPredictionSample
+{
+	GENERATED_BODY()
+
+	/** Predicted location of the updated component */
+	UPROPERTY(BlueprintReadOnly, Category = "Mover|Prediction")
+	FVector Location = FVector::ZeroVector;
+
+	/** Predicted velocity */
+	UPROPERTY(BlueprintReadOnly, Category = "Mover|Prediction")
+	FVector Velocity = FVector::ZeroVector;
+
+	/** Time since the start of the prediction */
+	UPROPERTY(BlueprintReadOnly, Category = "Mover|Prediction")
+	float Time = 0.0f;
+
+	/** True if the mover is standing on a walkable floor at this point */
+	UPROPERTY(BlueprintReadOnly, Category = "Mover|Prediction")
+	bool bGrounded = false;
+};
+
+/** Describes what to predict */
+USTRUCT(BlueprintType)
+struct COMMONMOVER_API FCommonMoverPredictionParams
+{
+	GENERATED_BODY()
+
+	/** Location to start the prediction from */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mover|Prediction")
+	FVector StartLocation = FVector::ZeroVector;
+
+	/** Velocity to start the prediction with */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mover|Prediction")
+	FVector StartVelocity = FVector::ZeroVector;
+
+	/** Whether the prediction starts on the ground */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mover|Prediction")
+	bool bStartGrounded = true;
+
+	/** Constant move input for the whole prediction, same as FCharacterDefaultInputs::GetMoveInput with a max length of 1 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mover|Prediction")
+	FVector MoveInput = FVector::ZeroVector;
+
+	/** How far into the future to predict */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mover|Prediction", meta=(ClampMin=0, ForceUnits="s"))
+	float Duration = 1.0f;
+
+	/** Time between predicted samples */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Mover|Prediction", meta=(ClampMin=0.001, ForceUnits="s"))
+	float TimeStep = 1.0f / 30.0f;
+};
+
+/** Everything a prediction needs to know about a mover, captured on the game thread so predictions can run on worker threads */
+struct COMMONMOVER_API FCommonMoverPredictionContext
+{
+	/** World to run the scene queries in */
+	TWeakObjectPtr<const UWorld> World;
+
+	/** Collision of the updated component */
+	FCollisionShape CollisionShape;
+	FQuat CollisionRotation = FQuat::Identity;
+	ECollisionChannel CollisionChannel = ECC_Pawn;
+	FCollisionQueryParams QueryParams;
+	FCollisionResponseParams ResponseParams;
+
+	/** Gravity and up direction of the mover */
+	FVector GravityAcceleration = FVector::ZeroVector;
+	FVector UpDirection = FVector::UpVector;
+
+	/** Movement settings of the mover */
+	float MaxSpeed = 800.0f;
+	float Acceleration = 4000.0f;
+	float Deceleration = 8000.0f;
+	float AirControlPercentage = 0.4f;
+	float MaxWalkSlopeCosine = 0.71f;
+	float MaxStepHeight = 40.0f;
+	float FloorSweepDistance = 40.0f;
+
+	/** Maximum distance a trajectory segment can stray from the actual parabola while airborne */
+	float TrajectoryTolerance = 2.0f;
+};
+
+/** A prediction request as used for batching */
+struct COMMONMOVER_API FCommonMoverPredictionRequest
+{
+	FCommonMoverPredictionContext Context;
+	FCommonMoverPredictionParams Params;
+
+	/** Filled in by the prediction */
+	TArray<FCommonMoverPredictionSample> Samples;
+};
+
+/** Predicts roughly where a mover will end up without moving it.
+ * This is an approximation, not a dry run of the simulation. It re-implements simplified versions of the ground and air stages
+ * (sharing only their static helpers) and runs scene queries against a scratch transform, so it has no side effects on components,
+ * the sync state or the blackboard. Results can drift from the real simulation, especially around step ups, wall slides,
+ * moving bases, coalesced moves and anything a derived mode overrides.
+ * No UObjects are touched while predicting, which means per-component walkable slope overrides are ignored. */
+struct COMMONMOVER_API FCommonMoverPrediction
+{
+	/** Maximum number of samples produced by a single prediction */
+	static constexpr int32 MaxSamples = 256;
+
+	/** Predicts a single trajectory. Must be called from the game thread. */
+	static void Predict(const FCommonMoverPredictionContext& Context, const FCommonMoverPredictionParams& Params, TArray<FCommonMoverPredictionSample>& OutSamples);
+
+	/** Predicts many trajectories across worker threads. Must be called from the game thread, which is blocked until all predictions finished. */
+	static void PredictBatch(TArrayView<FCommonMoverPredictionRequest> Requests);
+
+private:
+	/** Scratch state of a running prediction */
+	struct FScratchState
+	{
+		FVector Location = FVector::ZeroVector;
+		FVector Velocity = FVector::ZeroVector;
+		FVector FloorNormal = FVector::UpVector;
+		bool bGrounded = false;
+	};
+
+	/** Predicts a single trajectory in a world resolved on the game thread. Safe to call from worker threads. */
+	static void PredictInWorld(const UWorld& World, const FCommonMoverPredictionContext& Context, const FCommonMoverPredictionParams& Params, TArray<FCommonMoverPredictionSample>& OutSamples);
+
+	/** Accelerates the planar velocity towards the move input */
+	static void ApplyInput(const FCommonMoverPredictionContext& Context, const FVector& MoveInput, float DeltaSeconds, FScratchState& State);
+
+	/** Dry version of the ground move: ramps, step ups, wall slides and the floor check */
+	static void StepGround(const UWorld& World, const FCommonMoverPredictionContext& Context, float DeltaSeconds, FScratchState& State);
+
+	/** Dry version of the air move: ballistic trajectory sweeps, landing and surface slides */
+	static void StepAir(const UWorld& World, const FCommonMoverPredictionContext& Context, float DeltaSeconds, FScratchState& State);
+
+	/** Tries to step up onto the obstacle we hit. Returns true and moves the scratch location if we could. */
+	static bool TryStepUp(const UWorld& World, const FCommonMoverPredictionContext& Context, const FVector& Delta, FScratchState& State);
+
+	/** Looks for a walkable floor below the scratch location and snaps onto it */
+	static void FindFloor(const UWorld& World, const FCommonMoverPredictionContext& Context, FScratchState& State);
+
+	/** Sweeps the collision shape and moves the scratch location as far as it got. Returns true on a blocking hit. */
+	static bool SweepAndMove(const UWorld& World, const FCommonMoverPredictionContext& Context, const FVector& Delta, FScratchState& State, FHitResult& OutHit);
+
+	/** Returns true if the hit surface is walkable, from its normal only so the hit component isn't touched */
+	static bool IsWalkable(const FCommonMoverPredictionContext& Context, const FHitResult& Hit);
+};
@@ -0,0 +1,37 @@
+// Copyright © 2024 MajorT. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+#include "UObject/ObjectKey.h"
+
+class UPrimitiveComponent;
+struct FHitResult;
+
+/** Caches the step up eligibility of static geometry that lets its owner decide (CanCharacterStepUpOn set to Owner).
+ * That check asks the owning actor every time, while everything else about walkability is a flag or normal test that's cheaper to run than to look up.
+ * Owners whose CanBeBaseForCharacter answer changes at runtime need to be invalidated. */
+class COMMONMOVER_API FCommonWalkabilityCache
+{
+public:
+	/** Cached version of UPrimitiveComponent::CanCharacterStepUp for the hit component */
+	bool CanCharacterStepUp(const FHitResult& Hit);
+
+	/** Drops everything cached for the component */
+	void InvalidateComponent(const UPrimitiveComponent* Component);
+
+	/** Drops the whole cache */
+	void Reset();
+
+	/** Returns the number of cached components */
+	int32 Num() const { return Components.Num(); }
+
+public:
+	/** Maximum number of cached components before the cache gets flushed */
+	int32 MaxCachedComponents = 4096;
+
+private:
+	/** Cached step up results per component */
+	TMap<TObjectKey<UPrimitiveComponent>, bool> Components;
+};
@@ -0,0 +1,73 @@
+// Copyright © 2024 MajorT. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "CommonMoverPawnPoolSubsystem.generated.h"
+
+class ACommonMoverPawn;
+
+/** Inactive pawns of a single class */
+USTRUCT()
+struct FCommonMoverPawnPool
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<ACommonMoverPawn>> Pawns;
+};
+
+/** Keeps released CommonMover pawns around so they can be reused instead of spawned again.
+ * Reused pawns keep their components and registered movement modes, only their Mover state gets reset. */
+UCLASS()
+class COMMONMOVER_API UCommonMoverPawnPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	//~ Begin UWorldSubsystem Interface
+	virtual void Deinitialize() override;
+	//~ End UWorldSubsystem Interface
+
+	/** Returns an inactive pawn of the class placed at the transform and moving at the velocity, or spawns a new one if the pool is empty */
+	UFUNCTION(BlueprintCallable, Category="Mover|Pool")
+	ACommonMoverPawn* AcquirePawn(TSubclassOf<ACommonMoverPawn> PawnClass, const FTransform& Transform, const FVector& Velocity = FVector::ZeroVector);
+
+	/** Deactivates the pawn and returns it to the pool. The pawn gets destroyed if the pool of its class is full. */
+	UFUNCTION(BlueprintCallable, Category="Mover|Pool")
+	void ReleasePawn(ACommonMoverPawn* Pawn);
+
+	/** Spawns pawns of the class until its pool holds the given number of inactive pawns */
+	UFUNCTION(BlueprintCallable, Category="Mover|Pool")
+	void PrewarmPool(TSubclassOf<ACommonMoverPawn> PawnClass, int32 Count);
+
+	/** Returns the number of inactive pawns of the class */
+	UFUNCTION(BlueprintPure, Category="Mover|Pool")
+	int32 GetNumPooledPawns(TSubclassOf<ACommonMoverPawn> PawnClass) const;
+
+protected:
+	/** Spawns a new pawn of the class */
+	ACommonMoverPawn* SpawnPawn(TSubclassOf<ACommonMoverPawn> PawnClass, const FTransform& Transform) const;
+
+	/** Hides the pawn and stops its simulation */
+	void DeactivatePawn(ACommonMoverPawn* Pawn) const;
+
+	/** Shows the pawn, resets its Mover state and places it at the transform */
+	void ActivatePawn(ACommonMoverPawn* Pawn, const FTransform& Transform, const FVector& Velocity) const;
+
+public:
+	/** Maximum number of inactive pawns kept per class */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Mover|Pool", meta=(ClampMin=0))
+	int32 MaxPooledPawnsPerClass = 32;
+
+	/** Location inactive pawns are parked at, out of the way of any gameplay */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Mover|Pool")
+	FVector ParkingLocation = FVector(0.0f, 0.0f, -100000.0f);
+
+protected:
+	/** Inactive pawns by class */
+	UPROPERTY(Transient)
+	TMap<TSubclassOf<ACommonMoverPawn>, FCommonMoverPawnPool> Pools;
+};
@@ -0,0 +1,92 @@
+// Copyright © 2024 MajorT. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+
+#include "CommonMoverSpatialHashSubsystem.generated.h"
+
+class UCommonMoverComponent;
+
+/** A mover stored in the spatial hash */
+struct FCommonMoverSpatialEntry
+{
+	/** The registered mover */
+	TWeakObjectPtr<UCommonMoverComponent> Mover;
+
+	/** Key of the mover in the hash, still valid after the mover got destroyed */
+	TObjectKey<UCommonMoverComponent> MoverKey;
+
+	/** Location of the mover's updated component, as of its last simulation frame */
+	FVector Location = FVector::ZeroVector;
+
+	/** Capsule extents of the mover */
+	float Radius = 0.0f;
+	float HalfHeight = 0.0f;
+
+	/** Grid cell the mover is stored in */
+	FIntPoint Cell = FIntPoint::ZeroValue;
+};
+
+/** Keeps every registered CommonMover in a uniform grid on the ground plane.
+ * Answers "which movers are near me" with a few cell lookups instead of physics overlaps. Movers only touch the grid when they change cells. */
+UCLASS()
+class COMMONMOVER_API UCommonMoverSpatialHashSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	//~ Begin UWorldSubsystem Interface
+	virtual void Deinitialize() override;
+	//~ End UWorldSubsystem Interface
+
+	/** Adds a mover to the hash, or updates it if it is already registered */
+	void RegisterMover(UCommonMoverComponent* Mover, const FVector& Location, float Radius, float HalfHeight);
+
+	/** Removes a mover from the hash */
+	void UnregisterMover(const UCommonMoverComponent* Mover);
+
+	/** Updates the location of a registered mover */
+	void UpdateMover(const UCommonMoverComponent* Mover, const FVector& Location);
+
+	/** Calls the visitor for every mover whose location is within the radius of the center */
+	void ForEachMoverInRadius(const FVector& Center, float Radius, TFunctionRef<void(const FCommonMoverSpatialEntry&)> Visitor) const;
+
+	/** Finds every mover within the radius of the center. Returns the number of movers found. */
+	UFUNCTION(BlueprintCallable, Category = "Mover|Spatial")
+	int32 FindMoversInRadius(const FVector& Center, float Radius, TArray<UCommonMoverComponent*>& OutMovers, const UCommonMoverComponent* IgnoredMover = nullptr) const;
+
+	/** Finds up to the given number of movers closest to the center, within the max radius, sorted from the closest. Returns the number of movers found. */
+	UFUNCTION(BlueprintCallable, Category = "Mover|Spatial")
+	int32 FindNearestMovers(const FVector& Center, int32 MaxCount, float MaxRadius, TArray<UCommonMoverComponent*>& OutMovers, const UCommonMoverComponent* IgnoredMover = nullptr) const;
+
+	/** Returns the number of registered movers */
+	int32 Num() const { return Entries.Num(); }
+
+protected:
+	/** Returns the grid cell containing the location */
+	FIntPoint GetCell(const FVector& Location) const;
+
+	/** Adds the entry to the cell */
+	void AddToCell(const FIntPoint& Cell, int32 EntryIdx);
+
+	/** Removes the entry from the cell */
+	void RemoveFromCell(const FIntPoint& Cell, int32 EntryIdx);
+
+public:
+	/** Size of a grid cell. Should be around the most common query radius. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Mover|Spatial", meta=(ClampMin=1, ForceUnits="cm"))
+	float CellSize = 400.0f;
+
+protected:
+	/** Densely packed entries */
+	TArray<FCommonMoverSpatialEntry> Entries;
+
+	/** Entry index of every registered mover */
+	TMap<TObjectKey<UCommonMoverComponent>, int32> EntryIndices;
+
+	/** Entry indices stored in each occupied cell */
+	TMap<FIntPoint, TArray<int32, TInlineAllocator<4>>> Cells;
+};